@@ -0,0 +1,732 @@
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "sources/Matrix.hpp"
+#include "sources/Simd.hpp"
+#include "sources/ThreadPool.hpp"
+
+/*
+ * Benchmark of every public operator of zich::Matrix over a sweep of shapes.
+ * Each case is timed in batches: a warm-up call, then enough iterations per batch to last --min-time seconds,
+ * repeated --repetitions times. The reported time is the median batch, divided by its iterations.
+ * GFLOP/s and GB/s are the nominal work of the operation (what it computes and the matrix bytes it must read and
+ * write without caches, see Operands) over that time, so operations served from a cache (the comparison
+ * operators reuse the cached sums) report more than the hardware could deliver.
+ *
+ * With --compare, the run is checked against a baseline written earlier with --json (see compare()):
+ * a case regresses when its mean time grew by more than --threshold percent and the 95% confidence
+ * intervals of the two means do not overlap, so the noise within a run does not fail the check. The exit status
+ * is 1 if any case regressed. The intervals do not cover differences between machines (or a busy machine):
+ * record the baseline where the check runs.
+ *
+ * To compile and run: make bench, or make bench-compare against benchmark_baseline.json
+ * Usage: benchmark [--json FILE] [--compare BASELINE] [--threshold PERCENT] [--filter TEXT] [--repetitions N]
+ *                  [--min-time SECONDS] [--threads N]
+ */
+using namespace zich;
+using std::size_t;
+using std::string;
+using std::vector;
+
+namespace {
+
+    struct Options {
+        string json;
+        string filter; // substring of "operation/shape"
+        string compare; // baseline JSON
+        double threshold = 5; // percent
+        unsigned repetitions = 5;
+        double min_time = 0.05;
+        unsigned threads = 0;
+    };
+
+    struct Shape {
+        const char *name;
+        int rows;
+        int cols;
+    };
+
+    /*
+     * Products multiply by a dense cols x cols matrix, so the tall-skinny shape also covers the
+     * long and thin GEMM that a square sweep misses.
+     */
+    const Shape SHAPES[] = {
+            {"tiny",        3,    3},
+            {"square",      256,  256},
+            {"tall-skinny", 4096, 16},
+            {"huge",        2048, 2048},
+    };
+
+    struct Case {
+        string operation;
+        double flops; // per call
+        double bytes; // per call
+        std::function<void(size_t)> run; // calls the operation the given number of times
+    };
+
+    /*
+     * 95% confidence interval of a mean: mean +- half_width.
+     */
+    struct Interval {
+        double mean;
+        double half_width;
+
+        double low() const { return mean - half_width; }
+
+        double high() const { return mean + half_width; }
+    };
+
+    struct Result {
+        string operation;
+        const Shape *shape;
+        double flops;
+        double bytes;
+        size_t iterations; // per batch
+        vector<double> samples; // ns per call, one per batch
+        double median;
+        Interval interval;
+    };
+
+    /**
+     * Keeps the compiler from dropping a computation whose result is unused.
+     */
+    template<class T>
+    void keep(const T &value) {
+        asm volatile("" : : "r"(&value) : "memory");
+    }
+
+    /**
+     * Deterministic multiples of 1/1024 in [-1, 1), the same on every platform (splitmix64).
+     * They print in fixed notation, which is the only one operator>> reads.
+     */
+    vector<double> randomValues(size_t size, std::uint64_t seed) {
+        vector<double> values(size);
+        for (double &value : values) {
+            seed += 0x9E3779B97F4A7C15ULL;
+            std::uint64_t bits = seed;
+            bits = (bits ^ (bits >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+            bits = (bits ^ (bits >> 27U)) * 0x94D049BB133111EBULL;
+            bits ^= bits >> 31U;
+            value = static_cast<double>(bits >> 53U) / 1024 - 1;
+        }
+        return values;
+    }
+
+    /**
+     * Householder reflection I - 2 v v^T / (v^T v): dense, so no structure fast path applies, and its own
+     * inverse, so repeated *= keeps the operand bounded.
+     */
+    Matrix householder(int size) {
+        const vector<double> v = randomValues(static_cast<size_t>(size), 3);
+        double norm = 0;
+        for (double value : v) {
+            norm += value * value;
+        }
+        vector<double> entries(v.size() * v.size());
+        for (size_t i = 0; i < v.size(); ++i) {
+            for (size_t j = 0; j < v.size(); ++j) {
+                entries[i * v.size() + j] = (i == j ? 1 : 0) - 2 * v[i] * v[j] / norm;
+            }
+        }
+        return Matrix{entries, size, size};
+    }
+
+    /**
+     * Reads a string in place, so every >> iteration parses the same text without copying it.
+     */
+    class InputBuffer : public std::streambuf {
+    public:
+        void reset(const string &text) {
+            char *begin = const_cast<char *>(text.data()); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+            setg(begin, begin, begin + text.size());
+        }
+    };
+
+    /**
+     * Counts and discards output.
+     */
+    class CountingBuffer : public std::streambuf {
+    private:
+        size_t _count = 0;
+
+    protected:
+        int_type overflow(int_type c) override {
+            ++_count;
+            return traits_type::not_eof(c);
+        }
+
+        std::streamsize xsputn(const char *, std::streamsize count) override {
+            _count += static_cast<size_t>(count);
+            return count;
+        }
+
+    public:
+        size_t count() const { return _count; }
+    };
+
+    /**
+     * Inputs of every case of one shape. The benchmarks that modify a matrix keep it bounded:
+     * *= scalar alternates 2 and 0.5 (exact), *= matrix multiplies by a reflection, the others drift linearly.
+     */
+    struct Operands {
+        Matrix left;
+        Matrix right; // same shape as left
+        Matrix square; // cols x cols, dense
+        Matrix reflection; // cols x cols, its own inverse
+        string text; // left in the >> format
+        size_t printed; // bytes of left in the << format
+
+        explicit Operands(const Shape &shape)
+                : left{randomValues(static_cast<size_t>(shape.rows * shape.cols), 1), shape.rows, shape.cols},
+                  right{randomValues(static_cast<size_t>(shape.rows * shape.cols), 2), shape.rows, shape.cols},
+                  square{randomValues(static_cast<size_t>(shape.cols * shape.cols), 4), shape.cols, shape.cols},
+                  reflection{householder(shape.cols)}, printed{0} {
+            std::ostringstream out;
+            out << left;
+            const string printed_text = out.str();
+            printed = printed_text.size();
+            // a single line, rows separated by ", " instead of a newline
+            text.reserve(printed + static_cast<size_t>(shape.rows) + 1);
+            for (char c : printed_text) {
+                if (c == '\n') {
+                    text += ", ";
+                } else {
+                    text += c;
+                }
+            }
+            text += '\n';
+        }
+    };
+
+    vector<Case> cases(Operands &operands, const Shape &shape) {
+        const double n = static_cast<double>(shape.rows) * shape.cols;
+        const double m = shape.rows;
+        const double k = shape.cols;
+        const double e = sizeof(double);
+        const double product_flops = 2 * m * k * k;
+        const double product_bytes = e * (m * k + k * k + m * k);
+        Matrix &a = operands.left;
+        const Matrix &b = operands.right;
+        Operands *o = &operands;
+
+        return {
+                {"operator+()",  0,             2 * e * n, [&a](size_t count) {
+                    for (size_t i = 0; i < count; ++i) {
+                        keep(+a);
+                    }
+                }},
+                {"operator-()",  n,             2 * e * n, [&a](size_t count) {
+                    for (size_t i = 0; i < count; ++i) {
+                        keep(-a);
+                    }
+                }},
+                {"operator+",    n,             3 * e * n, [&a, &b](size_t count) {
+                    for (size_t i = 0; i < count; ++i) {
+                        keep(a + b);
+                    }
+                }},
+                {"operator-",    n,             3 * e * n, [&a, &b](size_t count) {
+                    for (size_t i = 0; i < count; ++i) {
+                        keep(a - b);
+                    }
+                }},
+                {"operator+=",   n,             3 * e * n, [&a, &b](size_t count) {
+                    for (size_t i = 0; i < count; ++i) {
+                        keep(a += b);
+                    }
+                }},
+                {"operator-=",   n,             3 * e * n, [&a, &b](size_t count) {
+                    for (size_t i = 0; i < count; ++i) {
+                        keep(a -= b);
+                    }
+                }},
+                {"operator>",    2 * n,         2 * e * n, [&a, &b](size_t count) {
+                    for (size_t i = 0; i < count; ++i) {
+                        keep(a > b);
+                    }
+                }},
+                {"operator>=",   2 * n,         2 * e * n, [&a, &b](size_t count) {
+                    for (size_t i = 0; i < count; ++i) {
+                        keep(a >= b);
+                    }
+                }},
+                {"operator<",    2 * n,         2 * e * n, [&a, &b](size_t count) {
+                    for (size_t i = 0; i < count; ++i) {
+                        keep(a < b);
+                    }
+                }},
+                {"operator<=",   2 * n,         2 * e * n, [&a, &b](size_t count) {
+                    for (size_t i = 0; i < count; ++i) {
+                        keep(a <= b);
+                    }
+                }},
+                {"operator==",   0,             2 * e * n, [&a, &b](size_t count) {
+                    for (size_t i = 0; i < count; ++i) {
+                        keep(a == b);
+                    }
+                }},
+                {"operator!=",   0,             2 * e * n, [&a, &b](size_t count) {
+                    for (size_t i = 0; i < count; ++i) {
+                        keep(a != b);
+                    }
+                }},
+                {"operator++()", n,             2 * e * n, [&a](size_t count) {
+                    for (size_t i = 0; i < count; ++i) {
+                        keep(++a);
+                    }
+                }},
+                {"operator--()", n,             2 * e * n, [&a](size_t count) {
+                    for (size_t i = 0; i < count; ++i) {
+                        keep(--a);
+                    }
+                }},
+                {"operator++(int)", n,          4 * e * n, [&a](size_t count) {
+                    for (size_t i = 0; i < count; ++i) {
+                        keep(a++);
+                    }
+                }},
+                {"operator--(int)", n,          4 * e * n, [&a](size_t count) {
+                    for (size_t i = 0; i < count; ++i) {
+                        keep(a--);
+                    }
+                }},
+                {"operator*=(double)", n,       2 * e * n, [&a](size_t count) {
+                    for (size_t i = 0; i < count; ++i) {
+                        keep(a *= (i % 2 == 0 ? 2.0 : 0.5));
+                    }
+                }},
+                {"operator*(double)", n,        2 * e * n, [&a](size_t count) {
+                    for (size_t i = 0; i < count; ++i) {
+                        keep(a * 2.0);
+                    }
+                }},
+                {"operator*(double, Matrix)", n, 2 * e * n, [&a](size_t count) {
+                    for (size_t i = 0; i < count; ++i) {
+                        keep(2.0 * a);
+                    }
+                }},
+                {"operator*",    product_flops, product_bytes, [&a, o](size_t count) {
+                    for (size_t i = 0; i < count; ++i) {
+                        keep(a * o->square);
+                    }
+                }},
+                {"operator*=",   product_flops, product_bytes, [&a, o](size_t count) {
+                    for (size_t i = 0; i < count; ++i) {
+                        keep(a *= o->reflection);
+                    }
+                }},
+                {"operator<<",   0, static_cast<double>(operands.printed), [&a](size_t count) {
+                    CountingBuffer buffer;
+                    std::ostream out{&buffer};
+                    for (size_t i = 0; i < count; ++i) {
+                        out << a;
+                    }
+                    keep(buffer.count());
+                }},
+                {"operator>>",   0, static_cast<double>(operands.text.size()), [o](size_t count) {
+                    Matrix target{{0}, 1, 1};
+                    InputBuffer buffer;
+                    std::istream in{&buffer};
+                    for (size_t i = 0; i < count; ++i) {
+                        buffer.reset(o->text);
+                        in >> target;
+                    }
+                    keep(target);
+                }},
+        };
+    }
+
+    // ****************
+    // statistics
+    // ****************
+
+    /**
+     * Two-sided 95% quantile of Student's t distribution.
+     */
+    double studentT(size_t degrees) {
+        static const double QUANTILES[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                           2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                           2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+        const size_t count = sizeof(QUANTILES) / sizeof(QUANTILES[0]);
+        return degrees <= count ? QUANTILES[degrees - 1] : 1.96;
+    }
+
+    /**
+     * Batches are long enough for their means to be close to normal, so the t interval applies.
+     * A single sample has no spread: its interval is the point itself.
+     */
+    Interval confidence(const vector<double> &samples) {
+        double mean = 0;
+        for (double sample : samples) {
+            mean += sample;
+        }
+        mean /= static_cast<double>(samples.size());
+        if (samples.size() < 2) {
+            return Interval{mean, 0};
+        }
+        double squares = 0;
+        for (double sample : samples) {
+            squares += (sample - mean) * (sample - mean);
+        }
+        const double count = static_cast<double>(samples.size());
+        const double deviation = std::sqrt(squares / (count - 1));
+        return Interval{mean, studentT(samples.size() - 1) * deviation / std::sqrt(count)};
+    }
+
+    double seconds(const Case &benchmark, size_t iterations) {
+        const auto start = std::chrono::steady_clock::now();
+        benchmark.run(iterations);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+
+    Result measure(const Case &benchmark, const Shape &shape, const Options &options) {
+        double elapsed = seconds(benchmark, 1); // warm-up: page faults, caches, thread pool workers
+        size_t iterations = 1;
+        while (elapsed < options.min_time / 8) {
+            iterations *= 8;
+            elapsed = seconds(benchmark, iterations);
+        }
+        iterations = std::max<size_t>(1, static_cast<size_t>(
+                std::ceil(static_cast<double>(iterations) * options.min_time / elapsed)));
+
+        Result result{benchmark.operation, &shape, benchmark.flops, benchmark.bytes, iterations, {}, 0, {0, 0}};
+        for (unsigned r = 0; r < options.repetitions; ++r) {
+            result.samples.push_back(seconds(benchmark, iterations) * 1e9 / static_cast<double>(iterations));
+        }
+        vector<double> sorted{result.samples};
+        std::sort(sorted.begin(), sorted.end());
+        const size_t middle = sorted.size() / 2;
+        result.median = sorted.size() % 2 == 1 ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) / 2;
+        result.interval = confidence(result.samples);
+        return result;
+    }
+
+    // ****************
+    // output
+    // ****************
+
+    string jsonString(const string &text) {
+        string quoted{"\""};
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                quoted += '\\';
+            }
+            quoted += c;
+        }
+        return quoted + '"';
+    }
+
+    void printRow(const Result &result) {
+        std::cout << std::left << std::setw(28) << result.operation << std::setw(13) << result.shape->name
+                  << std::right << std::fixed << std::setprecision(1) << std::setw(16) << result.median
+                  << std::setprecision(3) << std::setw(12) << result.flops / result.median
+                  << std::setw(12) << result.bytes / result.median << std::setw(12) << result.iterations << '\n';
+    }
+
+    void writeJson(const string &path, const vector<Result> &results, const Options &options) {
+        std::ofstream out{path};
+        if (!out) {
+            throw std::runtime_error{"Could not open " + path};
+        }
+        out << std::setprecision(9);
+        out << "{\n  \"context\": {\"simd\": " << jsonString(simd::kernels().name)
+            << ", \"threads\": " << ThreadPool::threadLimit() << ", \"repetitions\": " << options.repetitions
+            << ", \"min_time\": " << options.min_time << "},\n  \"benchmarks\": [";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result &result = results[i];
+            out << (i == 0 ? "\n" : ",\n") << "    {\"operation\": " << jsonString(result.operation)
+                << ", \"shape\": " << jsonString(result.shape->name) << ", \"rows\": " << result.shape->rows
+                << ", \"cols\": " << result.shape->cols << ", \"iterations\": " << result.iterations
+                << ", \"ns_per_op\": " << result.median << ", \"gflops\": " << result.flops / result.median
+                << ", \"gbps\": " << result.bytes / result.median << ", \"mean_ns\": " << result.interval.mean
+                << ", \"ci95_ns\": " << result.interval.half_width << ", \"samples_ns\": [";
+            for (size_t s = 0; s < result.samples.size(); ++s) {
+                out << (s == 0 ? "" : ", ") << result.samples[s];
+            }
+            out << "]}";
+        }
+        out << "\n  ]\n}\n";
+        if (!out) {
+            throw std::runtime_error{"Could not write " + path};
+        }
+    }
+
+    // ****************
+    // baseline
+    // ****************
+
+    /*
+     * Just enough JSON to read back what writeJson wrote (any valid JSON without escapes other than \" and \\).
+     */
+    struct Json {
+        enum Type {
+            NUMBER, STRING, ARRAY, OBJECT, LITERAL // LITERAL: true, false or null
+        };
+        Type type = LITERAL;
+        double number = 0;
+        string text;
+        vector<string> keys; // of an object, in the order of values
+        vector<Json> values; // of an array or object
+
+        /**
+         * @return member with this key, or nullptr
+         */
+        const Json *find(const string &key) const {
+            for (size_t i = 0; i < keys.size(); ++i) {
+                if (keys[i] == key) {
+                    return &values[i];
+                }
+            }
+            return nullptr;
+        }
+    };
+
+    class JsonReader {
+    private:
+        const string &_text;
+        size_t _pos = 0;
+
+        [[noreturn]] void fail() const {
+            throw std::runtime_error{"Invalid JSON at offset " + std::to_string(_pos)};
+        }
+
+        void skipSpaces() {
+            while (_pos < _text.size() && std::isspace(static_cast<unsigned char>(_text[_pos])) != 0) {
+                ++_pos;
+            }
+        }
+
+        char peek() {
+            skipSpaces();
+            if (_pos >= _text.size()) {
+                fail();
+            }
+            return _text[_pos];
+        }
+
+        void expect(char c) {
+            if (peek() != c) {
+                fail();
+            }
+            ++_pos;
+        }
+
+        string readString() {
+            expect('"');
+            string text;
+            while (_pos < _text.size() && _text[_pos] != '"') {
+                if (_text[_pos] == '\\') {
+                    ++_pos;
+                }
+                if (_pos < _text.size()) {
+                    text += _text[_pos++];
+                }
+            }
+            expect('"');
+            return text;
+        }
+
+    public:
+        explicit JsonReader(const string &text) : _text(text) {}
+
+        Json read() {
+            Json value;
+            const char c = peek();
+            if (c == '{' || c == '[') {
+                value.type = c == '{' ? Json::OBJECT : Json::ARRAY;
+                const char close = c == '{' ? '}' : ']';
+                ++_pos;
+                if (peek() == close) {
+                    ++_pos;
+                    return value;
+                }
+                do {
+                    if (value.type == Json::OBJECT) {
+                        value.keys.push_back(readString());
+                        expect(':');
+                    }
+                    value.values.push_back(read());
+                } while (peek() == ',' && (++_pos, true));
+                expect(close);
+            } else if (c == '"') {
+                value.type = Json::STRING;
+                value.text = readString();
+            } else if (c == '-' || std::isdigit(static_cast<unsigned char>(c)) != 0) {
+                value.type = Json::NUMBER;
+                size_t length = 0;
+                value.number = std::stod(_text.substr(_pos, 32), &length);
+                _pos += length;
+            } else {
+                const size_t start = _pos;
+                while (_pos < _text.size() && std::isalpha(static_cast<unsigned char>(_text[_pos])) != 0) {
+                    ++_pos;
+                }
+                value.text = _text.substr(start, _pos - start);
+                if (value.text != "true" && value.text != "false" && value.text != "null") {
+                    fail();
+                }
+            }
+            return value;
+        }
+    };
+
+    struct Baseline {
+        string key; // "operation/shape"
+        Interval interval;
+    };
+
+    vector<Baseline> readBaseline(const string &path) {
+        std::ifstream in{path};
+        if (!in) {
+            throw std::runtime_error{"Could not open " + path};
+        }
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        const string text = buffer.str();
+        const Json root = JsonReader{text}.read();
+        const Json *benchmarks = root.find("benchmarks");
+        if (benchmarks == nullptr || benchmarks->type != Json::ARRAY) {
+            throw std::runtime_error{path + " has no \"benchmarks\" array"};
+        }
+        vector<Baseline> baseline;
+        for (const Json &entry : benchmarks->values) {
+            const Json *operation = entry.find("operation");
+            const Json *shape = entry.find("shape");
+            const Json *samples = entry.find("samples_ns");
+            const Json *time = entry.find("ns_per_op");
+            if (operation == nullptr || shape == nullptr || (samples == nullptr && time == nullptr)) {
+                throw std::runtime_error{path + ": a benchmark needs operation, shape and samples_ns or ns_per_op"};
+            }
+            vector<double> values;
+            if (samples != nullptr) {
+                for (const Json &sample : samples->values) {
+                    values.push_back(sample.number);
+                }
+            }
+            if (values.empty()) {
+                values.push_back(time->number);
+            }
+            baseline.push_back(Baseline{operation->text + '/' + shape->text, confidence(values)});
+        }
+        return baseline;
+    }
+
+    /**
+     * Prints how every case of the run changed against the baseline (cases missing from either side are skipped).
+     * @return number of regressions
+     */
+    size_t compare(const vector<Result> &results, const vector<Baseline> &baseline, double threshold) {
+        size_t regressions = 0;
+        std::cout << "\nCompared with the baseline (mean ns/op +- 95% confidence interval, threshold "
+                  << std::defaultfloat << threshold
+                  << "%):\n";
+        for (const Result &result : results) {
+            const string key = result.operation + '/' + result.shape->name;
+            const auto base = std::find_if(baseline.begin(), baseline.end(),
+                                           [&key](const Baseline &entry) { return entry.key == key; });
+            if (base == baseline.end()) {
+                continue;
+            }
+            const Interval &before = base->interval;
+            const Interval &after = result.interval;
+            const double change = (after.mean / before.mean - 1) * 100;
+            const char *verdict = "";
+            if (change > threshold && after.low() > before.high()) {
+                verdict = "REGRESSION";
+                ++regressions;
+            } else if (change < -threshold && after.high() < before.low()) {
+                verdict = "improved";
+            }
+            std::cout << std::left << std::setw(12) << verdict << std::setw(28) << result.operation
+                      << std::setw(13) << result.shape->name << std::right << std::fixed << std::setprecision(1)
+                      << std::showpos << std::setw(8) << change << '%' << std::noshowpos << "   "
+                      << before.mean << " +- " << before.half_width << " -> " << after.mean << " +- "
+                      << after.half_width << '\n';
+        }
+        std::cout << (regressions == 0 ? "No regressions\n" : std::to_string(regressions) + " regression(s)\n");
+        return regressions;
+    }
+
+    // ****************
+    // command line
+    // ****************
+
+    Options parseOptions(int argc, char *argv[]) {
+        Options options;
+        const vector<string> args(argv + 1, argv + argc);
+        for (size_t i = 0; i < args.size(); ++i) {
+            if (i + 1 == args.size()) {
+                throw std::invalid_argument{"Missing value for " + args[i]};
+            }
+            const string &value = args[++i];
+            if (args[i - 1] == "--json") {
+                options.json = value;
+            } else if (args[i - 1] == "--compare") {
+                options.compare = value;
+            } else if (args[i - 1] == "--threshold") {
+                options.threshold = std::stod(value);
+            } else if (args[i - 1] == "--filter") {
+                options.filter = value;
+            } else if (args[i - 1] == "--repetitions") {
+                options.repetitions = static_cast<unsigned>(std::stoul(value));
+            } else if (args[i - 1] == "--min-time") {
+                options.min_time = std::stod(value);
+            } else if (args[i - 1] == "--threads") {
+                options.threads = static_cast<unsigned>(std::stoul(value));
+            } else {
+                throw std::invalid_argument{"Unknown option " + args[i - 1]};
+            }
+        }
+        if (options.repetitions == 0 || !(options.min_time > 0) || !(options.threshold >= 0)) {
+            throw std::invalid_argument{"--repetitions and --min-time must be positive, --threshold not negative"};
+        }
+        return options;
+    }
+
+}
+
+int main(int argc, char *argv[]) {
+    try {
+        const Options options = parseOptions(argc, argv);
+        const vector<Baseline> baseline = options.compare.empty() ? vector<Baseline>{} : readBaseline(options.compare);
+        ThreadPool::setMaxThreads(options.threads);
+        std::cout << "simd: " << simd::kernels().name << ", threads: " << ThreadPool::threadLimit() << "\n\n"
+                  << std::left << std::setw(28) << "operation" << std::setw(13) << "shape" << std::right
+                  << std::setw(16) << "ns/op" << std::setw(12) << "GFLOP/s" << std::setw(12) << "GB/s"
+                  << std::setw(12) << "iterations" << '\n';
+        vector<Result> results;
+        for (const Shape &shape : SHAPES) {
+            Operands operands{shape};
+            for (const Case &benchmark : cases(operands, shape)) {
+                if ((benchmark.operation + '/' + shape.name).find(options.filter) == string::npos) {
+                    continue;
+                }
+                results.push_back(measure(benchmark, shape, options));
+                printRow(results.back());
+            }
+        }
+        if (!options.json.empty()) {
+            writeJson(options.json, results, options);
+        }
+        if (!options.compare.empty() && compare(results, baseline, options.threshold) != 0) {
+            return 1;
+        }
+    } catch (const std::exception &exception) {
+        std::cerr << exception.what() << "\nUsage: " << argv[0]
+                  << " [--json FILE] [--compare BASELINE] [--threshold PERCENT] [--filter TEXT] [--repetitions N]"
+                     " [--min-time SECONDS] [--threads N]\n";
+        return 2;
+    }
+    return 0;
+}
@@ -1,6 +1,27 @@
 #include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <thread>
 #include "doctest.h"
 #include "sources/Matrix.hpp"
+#include "sources/ThreadPool.hpp"
+#include "sources/Simd.hpp"
+#include "sources/MatrixExpr.hpp"
+#include "sources/Strassen.hpp"
+#include "sources/FixedMatrix.hpp"
+#include "sources/Batched.hpp"
+#include "sources/MatrixFile.hpp"
+#include "sources/MatrixView.hpp"
+#include "sources/SparseMatrix.hpp"
+#include "sources/Structure.hpp"
+#include "sources/Reduce.hpp"
+#include "sources/Memory.hpp"
+#include "sources/Accounting.hpp"
+#include "sources/Counters.hpp"
+#include "sources/Trace.hpp"
 
 typedef unsigned int uint;
 
@@ -17,6 +38,17 @@ Matrix generateZeroMatrix(int rows, int cols) {
     return Matrix{matrix, rows, cols};
 }
 
+/**
+ * true if M has operator<
+ */
+template<class M, class = void>
+struct Ordered : std::false_type {
+};
+
+template<class M>
+struct Ordered<M, std::void_t<decltype(std::declval<M>() < std::declval<M>())>> : std::true_type {
+};
+
 TEST_CASE ("Bad Input- initializing matrix with negative dimensions") {
             CHECK_THROWS((Matrix{{}, 0, 0}););
             CHECK_THROWS((Matrix{{0, 1}, -2, -1}););
@@ -70,6 +102,274 @@ TEST_CASE ("Matrix Multiplication") {
 
 }
 
+/*
+ * Sizes are chosen so the blocked kernel runs with partial register tiles and several KC blocks.
+ */
+TEST_CASE ("Matrix Multiplication- blocked kernel matches the textbook loop") {
+    const int rows = 67;
+    const int shared = 300;
+    const int cols = 45;
+    std::vector<double> left(static_cast<uint>(rows * shared));
+    std::vector<double> right(static_cast<uint>(shared * cols));
+    for (uint i = 0; i < left.size(); ++i) {
+        left[i] = static_cast<double>(i % 17) * 0.25 - 1.5;
+    }
+    for (uint i = 0; i < right.size(); ++i) {
+        right[i] = static_cast<double>(i % 11) * 0.3 - 1.1;
+    }
+    std::vector<double> expected(static_cast<uint>(rows * cols));
+    for (uint i = 0; i < rows; ++i) {
+        for (uint j = 0; j < cols; ++j) {
+            double sum = 0;
+            for (uint k = 0; k < shared; ++k) {
+                sum += left[i * shared + k] * right[k * cols + j];
+            }
+            expected[i * cols + j] = sum;
+        }
+    }
+    Matrix product{Matrix{left, rows, shared} * Matrix{right, shared, cols}};
+            CHECK(product == Matrix{expected, rows, cols});
+            CHECK((Matrix{left, rows, shared}.multiply(Matrix{right, shared, cols}, 1) == product));
+            CHECK((Matrix{left, rows, shared}.multiply(Matrix{right, shared, cols}, 4) == product));
+            CHECK_THROWS((Matrix{left, rows, shared}.multiply(Matrix{left, rows, shared}, 2)));
+}
+
+TEST_CASE ("Matrix Multiplication- Strassen-Winograd mode") {
+    const int rows = 41; // odd sizes need padding
+    const int shared = 30;
+    const int cols = 53;
+    std::vector<double> left(static_cast<uint>(rows * shared));
+    std::vector<double> right(static_cast<uint>(shared * cols));
+    for (uint i = 0; i < left.size(); ++i) {
+        left[i] = static_cast<double>(i % 13) * 0.5 - 3;
+    }
+    for (uint i = 0; i < right.size(); ++i) {
+        right[i] = static_cast<double>(i % 7) * 0.75 - 2;
+    }
+    Matrix mat1{left, rows, shared};
+    Matrix mat2{right, shared, cols};
+    Matrix classic{mat1 * mat2};
+
+    zich::strassen::configure(true, 8);
+    Matrix fast{mat1 * mat2};
+    zich::strassen::configure(false);
+
+    const zich::strassen::ErrorBound bound = zich::strassen::errorBound(mat1, mat2, 8);
+            CHECK(bound.levels == 2);
+            CHECK(bound.strassen > bound.classic);
+    Matrix diff{fast - classic};
+    double max_error = 0;
+    for (uint i = 0; i < static_cast<uint>(rows * cols); ++i) {
+        max_error = std::max(max_error, std::abs(diff.data()[i]));
+    }
+            CHECK(max_error <= bound.strassen + bound.classic);
+            CHECK_FALSE(zich::strassen::config().enabled);
+}
+
+TEST_CASE ("Matrix Multiplication- batched small matrices") {
+    const size_t batch = 21; // two full interleaved groups and a partial one
+    const size_t rows = 3;
+    const size_t shared = 5;
+    const size_t cols = 2;
+    std::vector<double> left(batch * rows * shared);
+    std::vector<double> right(batch * shared * cols);
+    for (uint i = 0; i < left.size(); ++i) {
+        left[i] = static_cast<double>(i % 13) * 0.37 - 2;
+    }
+    for (uint i = 0; i < right.size(); ++i) {
+        right[i] = static_cast<double>(i % 9) * 0.61 - 2.5;
+    }
+    const std::vector<double> products{zich::batched::multiply(left, right, batch, rows, shared, cols, 2)};
+    uint mismatches = 0;
+    for (size_t b = 0; b < batch; ++b) {
+        Matrix mat1{std::vector<double>(left.begin() + static_cast<long>(b * rows * shared),
+                                        left.begin() + static_cast<long>((b + 1) * rows * shared)), 3, 5};
+        Matrix mat2{std::vector<double>(right.begin() + static_cast<long>(b * shared * cols),
+                                        right.begin() + static_cast<long>((b + 1) * shared * cols)), 5, 2};
+        Matrix expected{mat1 * mat2};
+        const auto first = products.begin() + static_cast<long>(b * rows * cols);
+        if (!std::equal(expected.data(), expected.data() + rows * cols, first)) {
+            ++mismatches;
+        }
+    }
+            CHECK(mismatches == 0);
+            CHECK_THROWS(zich::batched::multiply(left, right, batch - 1, rows, shared, cols));
+            CHECK_THROWS(zich::batched::multiply(left.data(), right.data(), nullptr, batch, 0, shared, cols));
+            CHECK(zich::batched::multiply(std::vector<double>{}, std::vector<double>{}, 0, rows, shared, cols).empty());
+}
+
+TEST_CASE ("Transpose") {
+    for (const std::pair<int, int> &dims: {std::pair<int, int>{1, 7}, {5, 5}, {70, 70}, {37, 130}, {131, 66}}) {
+        const int rows = dims.first;
+        const int cols = dims.second;
+        std::vector<double> values(static_cast<uint>(rows * cols));
+        for (uint i = 0; i < values.size(); ++i) {
+            values[i] = static_cast<double>(i) * 0.5 - 3;
+        }
+        const Matrix mat{values, rows, cols};
+        std::vector<double> expected(values.size());
+        for (uint i = 0; i < static_cast<uint>(rows); ++i) {
+            for (uint j = 0; j < static_cast<uint>(cols); ++j) {
+                expected[j * static_cast<uint>(rows) + i] = values[i * static_cast<uint>(cols) + j];
+            }
+        }
+        Matrix in_place{mat};
+        in_place.transposeInPlace();
+                CHECK(mat.transpose() == Matrix{expected, cols, rows});
+                CHECK(in_place == Matrix{expected, cols, rows});
+                CHECK(in_place.transposeInPlace() == mat);
+    }
+}
+
+TEST_CASE ("Structure") {
+    const Matrix identity{{1, 0, 0, 0, 1, 0, 0, 0, 1}, 3, 3};
+    const Matrix diagonal{{2, 0, 0, 0, -0.5, 0, 0, 0, 0}, 3, 3};
+    const Matrix upper{{1, 2, 3, 0, 4, 5, 0, 0, 6}, 3, 3};
+    const Matrix symmetric{{1, 2, 3, 2, 4, 5, 3, 5, 6}, 3, 3};
+    const Matrix other{{1.5, -0.0, 3, -2, 7, 0.25}, 3, 2};
+
+            SUBCASE("Detection") {
+                CHECK(identity.structure() == (structure::DIAGONAL | structure::IDENTITY | structure::UPPER |
+                                               structure::LOWER | structure::SYMMETRIC));
+                CHECK(upper.structure() == structure::UPPER);
+                CHECK(upper.transpose().structure() == structure::LOWER);
+                CHECK(symmetric.structure() == structure::SYMMETRIC);
+                CHECK(generateZeroMatrix(2, 3).structure() == structure::ZERO);
+                CHECK(other.structure() == 0);
+                CHECK(diagonal.hasStructure(structure::DIAGONAL | structure::SYMMETRIC));
+                CHECK_FALSE(diagonal.hasStructure(structure::IDENTITY));
+                CHECK_FALSE(generateZeroMatrix(2, 3).hasStructure(structure::DIAGONAL));
+                CHECK_NOTHROW(upper.expectStructure(structure::UPPER));
+                CHECK_THROWS(upper.expectStructure(structure::LOWER));
+    }
+
+            SUBCASE("Fast paths give the same bits as the full product") {
+        const Matrix left_diagonal{identity * other};
+        const Matrix right_diagonal{Matrix{other}.transposeInPlace() * diagonal};
+                CHECK(std::memcmp(left_diagonal.data(), Matrix{{1.5, 0, 3, -2, 7, 0.25}, 3, 2}.data(),
+                                  6 * sizeof(double)) == 0);
+                CHECK(diagonal * other == Matrix{{3, 0, -1.5, 1, 0, 0}, 3, 2});
+                CHECK(right_diagonal == Matrix{{3, -1.5, 0, 0, 1, 0}, 2, 3});
+                CHECK(std::signbit(right_diagonal.data()[3]) == false);
+                CHECK(generateZeroMatrix(2, 3) * other == generateZeroMatrix(2, 2));
+                CHECK(MatrixView{symmetric}.block(0, 0, 2, 2) * MatrixView{identity}.block(1, 1, 2, 2) ==
+                      Matrix{{1, 2, 2, 4}, 2, 2});
+    }
+
+            SUBCASE("Infinite entries take the full product") {
+        const Matrix infinite{{INFINITY, 1, 2, 3, 4, 5}, 3, 2};
+        const Matrix product{identity * infinite};
+                CHECK(product.data()[0] == INFINITY);
+                CHECK(std::isnan(product.data()[2]));
+                CHECK(std::isnan((generateZeroMatrix(2, 3) * infinite).data()[0]));
+    }
+}
+
+TEST_CASE ("Thread pool") {
+    std::vector<int> hits(100, 0);
+    zich::ThreadPool::instance().parallelFor(hits.size(), [&hits](size_t i) { ++hits[i]; }, 3);
+            CHECK(std::count(hits.begin(), hits.end(), 1) == 100);
+            CHECK(zich::ThreadPool::threadLimit(1) == 1);
+            CHECK_THROWS(zich::ThreadPool::instance().parallelFor(10, [](size_t i) {
+                if (i == 5) {
+                    throw std::runtime_error{"task failed"};
+                }
+            }));
+
+    static std::atomic<unsigned> releases{0};
+    void (*release)() = [] { ++releases; };
+    zich::ThreadPool::instance().releaseWhenIdle(release);
+    zich::ThreadPool::instance().releaseWhenIdle(release); // registered once
+    zich::ThreadPool::instance().parallelFor(hits.size(), [&hits](size_t i) { ++hits[i]; });
+    std::this_thread::sleep_for(3 * zich::ThreadPool::IDLE_RELEASE);
+    // each worker that ran a task released its scratch memory once (there are no workers on one core)
+            CHECK(releases.load() <= zich::ThreadPool::threadLimit() - 1);
+}
+
+/*
+ * Every variant the CPU supports must give the same bits as the scalar fallback (37 values exercise the tails).
+ */
+TEST_CASE ("SIMD kernels- all instruction sets agree") {
+    const zich::simd::Kernels *scalar = zich::simd::find("scalar");
+            CHECK(zich::simd::find("no-such-isa") == nullptr);
+    std::vector<double> src(37);
+    for (uint i = 0; i < src.size(); ++i) {
+        src[i] = static_cast<double>(i) * 1.37 - 20.1;
+    }
+    for (const char *name: {"sse2", "avx2", "avx512"}) {
+        const zich::simd::Kernels *variant = zich::simd::find(name);
+        if (variant == nullptr) {
+            continue;
+        }
+        std::vector<double> expected(src.size(), 0.5);
+        std::vector<double> actual(src.size(), 0.5);
+        scalar->add(expected.data(), src.data(), src.size());
+        variant->add(actual.data(), src.data(), src.size());
+        scalar->scale(expected.data(), -3.3, src.size());
+        variant->scale(actual.data(), -3.3, src.size());
+        scalar->sub(expected.data(), src.data(), src.size());
+        variant->sub(actual.data(), src.data(), src.size());
+        scalar->shift(expected.data(), 1, src.size());
+        variant->shift(actual.data(), 1, src.size());
+                CHECK(expected == actual);
+    }
+}
+
+/*
+ * 5000 entries span two chunks and a tail, so the chunked path is exercised as well.
+ */
+TEST_CASE ("Reductions") {
+    const Matrix mat{{3, -4, 1, 0, 2, -7}, 2, 3};
+    std::vector<double> values(5000);
+    for (uint i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<double>(i % 97) - 40.0;
+    }
+    const Matrix large{values, 50, 100};
+
+            SUBCASE("Sums") {
+                CHECK(reduce::sum(mat) == -5);
+                CHECK(reduce::sum(large) == 38834);
+                CHECK(reduce::sum(Matrix{{1e16, 1, -1e16}, 1, 3}) == 1);
+                CHECK(reduce::sum(MatrixView{large}.slice(1, 20, 2, 3, 30, 3)) ==
+                      reduce::sum(MatrixView{large}.slice(1, 20, 2, 3, 30, 3).toMatrix()));
+                CHECK(reduce::sum(large, 1) == reduce::sum(large, 4));
+                CHECK(reduce::rowSums(mat) == std::vector<double>{0, -5});
+                CHECK(reduce::colSums(mat) == std::vector<double>{3, -2, -6});
+    }
+
+            SUBCASE("Parallel sums do not depend on the number of threads") {
+        // 2^19 entries (the threaded, chunked path), repeating 1e16, 1, -1e16, 1: a left to right sum loses every 1
+        // added to 1e16 (half an ulp) and ends at 1, other orders of plain additions end elsewhere
+        std::vector<double> cancelling(size_t{1} << 19);
+        double naive = 0;
+        for (size_t i = 0; i < cancelling.size(); ++i) {
+            cancelling[i] = i % 2 == 1 ? 1 : i % 4 == 0 ? 1e16 : -1e16;
+            naive += cancelling[i];
+        }
+        const Matrix huge{cancelling, 512, 1024};
+        const double serial = reduce::sum(huge, 1);
+                CHECK(naive == 1);
+                CHECK(serial == 262144);
+        for (unsigned threads : {2U, 4U}) {
+            const double parallel = reduce::sum(huge, threads);
+                CHECK(std::memcmp(&parallel, &serial, sizeof(double)) == 0);
+                CHECK(reduce::rowSums(huge, threads) == reduce::rowSums(huge, 1));
+                CHECK(reduce::colSums(huge, threads) == reduce::colSums(huge, 1));
+        }
+    }
+
+            SUBCASE("Extremes and norms") {
+                CHECK(reduce::min(mat) == -7);
+                CHECK(reduce::max(large) == 56);
+                CHECK(std::isnan(reduce::max(Matrix{{1, NAN, 2}, 1, 3})));
+                CHECK(reduce::normFrobenius(Matrix{{3, 4}, 1, 2}) == 5);
+                CHECK(reduce::normFrobenius(Matrix{{3e300, 4e300}, 2, 1}) == doctest::Approx(5e300));
+                CHECK(reduce::normMax(mat) == 7);
+                CHECK(reduce::norm1(mat) == 8);
+                CHECK(reduce::normInf(mat) == 9);
+    }
+}
+
 /*
  * trying all three initializations
  * preferred is curly brackets (more info in header)
@@ -133,6 +433,29 @@ TEST_CASE ("Comparison Operators") {
                 CHECK_THROWS(mat2.operator>=(mat3));
     }
 
+            SUBCASE("Cached sums follow updates") {
+        Matrix values{{0.1, 0.2, 0.3, 1e16, -1e16, 0.7, 5, 3, -4}, 3, 3};
+        const Matrix copy{values};
+                CHECK(values > mat1);
+                CHECK(values <= copy);
+        values += mat1;
+        ++values;
+        values *= -2.5;
+        values -= mat4;
+        values = mat1 - std::move(values);
+        const Matrix fresh{std::vector<double>(values.data(), values.data() + 9), 3, 3};
+                CHECK((values < copy) == (fresh < copy));
+                CHECK((values > mat4) == (fresh > mat4));
+                CHECK(values >= fresh);
+                CHECK(values <= fresh);
+                CHECK_FALSE(values < fresh);
+        values.transposeInPlace();
+                CHECK(values >= fresh.transpose());
+        std::stringstream stream{"[1 2], [3 4]\n"};
+        stream >> values;
+                CHECK(values > Matrix{{1, 2, 3, 3.5}, 2, 2});
+    }
+
 }
 
 TEST_CASE ("Unary and Binary Operators (between matrices)") {
@@ -228,6 +551,599 @@ TEST_CASE ("Unary and Binary Operators (between matrices)") {
     }
 }
 
+TEST_CASE ("Temporaries reuse their buffers") {
+    Matrix mat1{{1.5, -2, 3.25, 4, 0, 6}, 2, 3};
+    Matrix mat2{{0.1, 0.2, 0.3, 0.4, 0.5, 0.6}, 2, 3};
+    Matrix mat3{{7, 8, 9, 10, 11, 12}, 2, 3};
+    Matrix expected{{(1.5 + 0.1 - 7) * 2, (-2 + 0.2 - 8) * 2, (3.25 + 0.3 - 9) * 2,
+                     (4 + 0.4 - 10) * 2, (0 + 0.5 - 11) * 2, (6 + 0.6 - 12) * 2}, 2, 3};
+
+    Matrix temp{mat1};
+    const double *buffer = temp.data();
+    Matrix res{-(2.0 * (std::move(temp) + mat2 - mat3))};
+            CHECK(res == -expected);
+            CHECK(res.data() == buffer); // the whole chain ran in the first temporary
+
+    Matrix right{mat2};
+    buffer = right.data();
+    Matrix diff{mat3 - std::move(right)};
+            CHECK(diff == mat3 - mat2);
+            CHECK(diff.data() == buffer);
+            CHECK((mat1 + (mat2 + mat3)) == (mat2 + mat3) + mat1);
+            CHECK(((mat1 * 1.0) - (mat2 * 1.0)) == mat1 - mat2);
+            CHECK_THROWS((mat1 - Matrix{{1, 2}, 1, 2}));
+            CHECK_THROWS((Matrix{{1, 2}, 1, 2} * Matrix{{1, 2}, 1, 2}));
+}
+
+/*
+ * 37 x 70 times 70 x 45 crosses the vector width and the blocking of every kernel.
+ * Small integers are exact in every element type, so all products must match the double one.
+ */
+TEST_CASE ("Element types") {
+    std::vector<double> left(37 * 70);
+    std::vector<double> right(70 * 45);
+    for (uint i = 0; i < left.size(); ++i) {
+        left[i] = static_cast<double>(i % 7) - 3;
+    }
+    for (uint i = 0; i < right.size(); ++i) {
+        right[i] = static_cast<double>(i % 5) - 2;
+    }
+    const Matrix product{Matrix{left, 37, 70} * Matrix{right, 70, 45}};
+
+            SUBCASE("Float, integer and complex products match double") {
+        const FloatMatrix float_product{FloatMatrix{std::vector<float>(left.begin(), left.end()), 37, 70} *
+                                        FloatMatrix{std::vector<float>(right.begin(), right.end()), 70, 45}};
+        const IntMatrix int_product{IntMatrix{std::vector<std::int32_t>(left.begin(), left.end()), 37, 70} *
+                                    IntMatrix{std::vector<std::int32_t>(right.begin(), right.end()), 70, 45}};
+        const ComplexMatrix complex_product{
+                ComplexMatrix{std::vector<std::complex<double>>(left.begin(), left.end()), 37, 70} *
+                ComplexMatrix{std::vector<std::complex<double>>(right.begin(), right.end()), 70, 45}};
+                CHECK(std::equal(product.data(), product.data() + 37 * 45, float_product.data()));
+                CHECK(std::equal(product.data(), product.data() + 37 * 45, int_product.data()));
+                CHECK(std::equal(product.data(), product.data() + 37 * 45, complex_product.data()));
+    }
+
+            SUBCASE("Arithmetic") {
+        FloatMatrix floats{{1.5f, -2, 0.25f, 4}, 2, 2};
+                CHECK((floats + floats) == FloatMatrix{{3, -4, 0.5f, 8}, 2, 2});
+                CHECK((2.0f * floats - floats) == floats);
+                CHECK(floats.transpose() == FloatMatrix{{1.5f, 0.25f, -2, 4}, 2, 2});
+                CHECK((++floats) == FloatMatrix{{2.5f, -1, 1.25f, 5}, 2, 2});
+                CHECK(floats > FloatMatrix{{2.5f, -1, 1.25f, 4}, 2, 2});
+        IntMatrix ints{{std::numeric_limits<std::int32_t>::max(), 2, -3, 4}, 2, 2};
+                CHECK((++ints).data()[0] == std::numeric_limits<std::int32_t>::min()); // wraps around
+                CHECK(ints < IntMatrix{{0, 0, 0, 0}, 2, 2});
+                CHECK((LongMatrix{{1, 2, 3, 4}, 2, 2} * LongMatrix{{5, 6, 7, 8}, 2, 2}) ==
+                      LongMatrix{{19, 22, 43, 50}, 2, 2});
+        const ComplexMatrix complex{{{1, 2}, {0, -1}}, 1, 2};
+                CHECK((complex * std::complex<double>{0, 1}) == ComplexMatrix{{{-2, 1}, {1, 0}}, 1, 2});
+                CHECK((complex * complex.transpose()).data()[0] == std::complex<double>{-4, 4});
+                CHECK_THROWS((complex + ComplexMatrix{{1, 2}, 2, 1}));
+        const ComplexMatrix infinite{{{INFINITY, 1}, {-0.0, NAN}}, 1, 2};
+        const ComplexMatrix negated{-infinite};
+                CHECK(negated.data()[0] == std::complex<double>{-INFINITY, -1});
+                CHECK(std::signbit(negated.data()[1].real()) == false);
+                CHECK(std::isnan(negated.data()[1].imag()));
+                CHECK(Ordered<FloatMatrix>::value);
+                CHECK(Ordered<IntMatrix>::value);
+                CHECK_FALSE(Ordered<ComplexMatrix>::value);
+    }
+
+            SUBCASE("Text input and output") {
+        std::stringstream stream;
+        ComplexFloatMatrix complex{{{0, 0}, {0, 0}}, 1, 2};
+        stream.str("[1.5-2i 3i], [-1 0.5+0.25i]\n");
+        stream >> complex;
+        std::stringstream output;
+        output << complex;
+                CHECK(output.str() == "[1.5-2i 0+3i]\n[-1 0.5+0.25i]");
+        IntMatrix ints{{0}, 1, 1};
+        stream.str("[1 -2], [30 4]\n");
+        stream >> ints;
+                CHECK(ints == IntMatrix{{1, -2, 30, 4}, 2, 2});
+        stream.str("[1.5 2]\n");
+                CHECK_THROWS_AS(stream >> ints, std::runtime_error);
+        stream.str("[3000000000 2]\n");
+                CHECK_THROWS_AS(stream >> ints, std::out_of_range);
+        stream.str("[1+-2i]\n");
+                CHECK_THROWS_AS(stream >> complex, std::runtime_error);
+        FloatMatrix floats{{0}, 1, 1};
+        stream.str("[0.5 -0.0]\n");
+        stream >> floats;
+        output.str("");
+        output << floats;
+                CHECK(output.str() == "[0.5 0]");
+    }
+}
+
+TEST_CASE ("Memory resources") {
+    const Matrix mat1{{1, 2, 3, 4}, 2, 2};
+    const Matrix mat2{{0.5, -1, 2, 0}, 2, 2};
+
+            SUBCASE("Pool recycles the buffers of temporaries") {
+        memory::PoolResource pool;
+        memory::ScopedResource scope{&pool};
+        for (int i = 0; i < 10; ++i) {
+            const Matrix result{(mat1 + mat2) * mat1 - mat2.transpose()};
+                    CHECK(result.resource() == &pool);
+        }
+                CHECK(pool.stats().allocations - pool.stats().reuses <= 3); // only the first round allocates
+                CHECK(pool.stats().cached > 0);
+                CHECK(memory::PoolResource::blockSize(100) == 112);
+                CHECK(memory::PoolResource::blockSize(129) == 160);
+        pool.release();
+                CHECK(pool.stats().cached == 0);
+    }
+
+            SUBCASE("Arena scope") {
+        Matrix outside{mat1};
+        Matrix kept{mat1};
+        {
+            memory::ScopedArena arena;
+                    CHECK(memory::current() == &arena.pool());
+            Matrix inside{mat1 * mat2};
+                    CHECK(inside.resource() == &arena.pool());
+            outside = inside + mat1; // assignment copies into the buffer outside already has
+            kept = Matrix{inside, memory::heap()};
+        }
+                CHECK(memory::current() == memory::heap());
+                CHECK(outside.resource() == memory::heap());
+                CHECK(outside == Matrix{{5.5, 1, 12.5, 1}, 2, 2});
+                CHECK(kept == Matrix{{4.5, -1, 9.5, -3}, 2, 2});
+                CHECK(kept > mat2);
+    }
+}
+
+TEST_CASE ("Aligned storage and huge pages") {
+    const std::vector<double> values(1 << 15, 0.25); // 256 KiB
+    const Matrix small{{1, 2, 3}, 1, 3};
+            CHECK(reinterpret_cast<uintptr_t>(small.data()) % memory::ALIGNMENT == 0);
+            CHECK(reinterpret_cast<uintptr_t>(small.transpose().data()) % memory::ALIGNMENT == 0);
+            CHECK(reinterpret_cast<uintptr_t>((small + small).data()) % memory::ALIGNMENT == 0);
+
+            SUBCASE("Per matrix") {
+        for (memory::HugePages huge_pages: {memory::HugePages::TRANSPARENT, memory::HugePages::EXPLICIT}) {
+            memory::AlignedResource resource{huge_pages, 1 << 16};
+            {
+                const Matrix large{Matrix{values, 128, 256}, &resource};
+                        CHECK(resource.mapped() == memory::HUGE_PAGE_SIZE);
+                        CHECK(reinterpret_cast<uintptr_t>(large.data()) % memory::ALIGNMENT == 0);
+                        CHECK(reduce::sum(large) == 8192);
+            }
+                    CHECK(resource.mapped() == 0);
+        }
+    }
+
+            SUBCASE("Globally") {
+        memory::setHugePages(memory::HugePages::TRANSPARENT);
+        const Matrix copy{small};
+                CHECK(copy.resource() == memory::heap(memory::HugePages::TRANSPARENT));
+        memory::setHugePages(memory::HugePages::NONE);
+                CHECK(memory::current() == memory::heap(memory::HugePages::NONE));
+                CHECK(Matrix{copy}.resource() == memory::heap(memory::HugePages::NONE));
+    }
+}
+
+TEST_CASE ("Performance counters") {
+    Matrix left{{1, 2, 3, 4, 5, 6}, 2, 3};
+    const Matrix right{{1, 0, 2, 1, 0, 3}, 3, 2};
+    counters::reset();
+    left += left; // not enabled yet
+            CHECK(counters::stats(counters::ADD).calls == 0);
+
+    counters::enable();
+    Matrix product{left * right};
+    ++product;
+    product--;
+    const Matrix negated{-product};
+    std::stringstream stream;
+    stream << product;
+    stream.str("[1 2], [3 4]\n");
+    stream >> product;
+    counters::enable(false);
+
+    const counters::Stats multiply = counters::stats(counters::MULTIPLY);
+            CHECK(multiply.calls == 1);
+            CHECK(multiply.flops == 24); // 2 * 2 * 3 * 2
+            CHECK(multiply.bytes == 8 * (6 + 6 + 4));
+            CHECK(counters::stats(counters::SHIFT).calls == 2); // postfix calls prefix
+            CHECK(counters::stats(counters::SCALE).calls == 1);
+            CHECK(counters::stats(counters::WRITE).bytes == 32);
+            CHECK(counters::stats(counters::READ).bytes == 32);
+            CHECK(counters::stats(counters::ADD).calls == 0);
+    if (counters::available(counters::INSTRUCTIONS)) { // not in every virtual machine
+                CHECK(multiply.counted[counters::INSTRUCTIONS] == 1);
+                CHECK(multiply.events[counters::INSTRUCTIONS] > 0);
+    }
+    std::stringstream report;
+    counters::report(report);
+            CHECK(report.str().find("operator*=") != std::string::npos);
+            CHECK(report.str().find("add") == std::string::npos);
+    counters::reset();
+            CHECK(counters::stats(counters::MULTIPLY).calls == 0);
+}
+
+TEST_CASE ("Tracing") {
+    Matrix left{{1, 2, 3, 4}, 2, 2};
+    const Matrix right{{0, 1, 1, 1}, 2, 2};
+    trace::clear();
+    left += right; // not enabled yet
+
+    trace::enable();
+    Matrix product{left * right};
+    std::thread worker{[&product] { ++product; }};
+    worker.join();
+    std::stringstream input{"[1 2], [3 4]\n"};
+    input >> product;
+    trace::enable(false);
+    product -= right; // not enabled anymore
+
+    std::stringstream json;
+    const size_t events = trace::writeChromeTrace(json);
+    const std::string text = json.str();
+            CHECK(text.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0) == 0);
+            CHECK(text.substr(text.size() - 3) == "]}\n");
+    if (trace::COMPILED) {
+                CHECK(events >= 6); // operator*, operator*=, operator++(), operator>>, read line, parse
+                CHECK(text.find("\"name\":\"operator*\",\"cat\":\"matrix\",\"ph\":\"X\"") != std::string::npos);
+                CHECK(text.find("\"args\":{\"rows\":2,\"cols\":2,\"flops\":16,\"bytes\":96}") != std::string::npos);
+                CHECK(text.find("\"name\":\"operator++()\"") != std::string::npos);
+                CHECK(text.find("\"name\":\"parse\"") != std::string::npos);
+                CHECK(text.find("operator+=") == std::string::npos);
+                CHECK(text.find("operator-=") == std::string::npos);
+        size_t threads = 0;
+        for (size_t pos = text.find("thread_name"); pos != std::string::npos; pos = text.find("thread_name", pos + 1)) {
+            ++threads;
+        }
+                CHECK(threads >= 2); // the worker has its own track
+    } else {
+                CHECK(events == 0);
+    }
+            CHECK(trace::dropped() == 0);
+    std::stringstream again;
+            CHECK(trace::writeChromeTrace(again) == 0); // drained
+}
+
+TEST_CASE ("Allocation accounting") {
+    Matrix left{{1, 2, 3, 4}, 2, 2};
+    const Matrix right{{0, 1, 1, 1}, 2, 2};
+    left *= right; // the product scratch buffer of this thread is allocated before counting
+    accounting::reset();
+    accounting::enable();
+
+            SUBCASE("Copies and allocations are charged to the outermost operator") {
+        const Matrix sum{left + right};
+        const Matrix chained{left + right + right}; // the second + reuses the temporary
+        const accounting::Counts plus = accounting::of("operator+");
+                CHECK(plus.copies == 2);
+                CHECK(plus.allocations == 2);
+                CHECK(plus.bytes == 2 * 4 * sizeof(double));
+                CHECK(accounting::of("operator+=").constructions == 0); // ran inside operator+
+        const Matrix copy{sum};
+        Matrix moved{std::move(copy)};
+        moved = chained;
+        const accounting::Counts outside = accounting::of(accounting::OUTSIDE);
+                CHECK(outside.copies == 3); // a const rvalue is copied
+                CHECK(outside.moves == 0);
+                CHECK(outside.allocations == 2); // the assignment reuses the buffer of moved
+        moved = Matrix{{5}, 1, 1};
+                CHECK(accounting::of(accounting::OUTSIDE).moves == 1);
+    }
+
+            SUBCASE("Hot paths do not allocate") {
+        left += right;
+        left -= right;
+        ++left;
+        left *= 2;
+        left *= right;
+        const bool greater = left > right;
+                CHECK(greater);
+                CHECK(accounting::total().allocations == 0);
+                CHECK(accounting::total().copies == 0);
+        const Matrix negated{-left};
+        const Matrix incremented{left++};
+                CHECK(accounting::of("operator-()").copies == 1);
+                CHECK(accounting::of("operator++(int)").copies == 1);
+                CHECK(accounting::of("operator-()").allocations == 1);
+    }
+
+            SUBCASE("Input growth and lazy expressions") {
+        std::stringstream input{"[1 2 3 4 5]\n"};
+        input >> left;
+                CHECK(accounting::of("operator>>").allocations == 4); // capacity 1, 2, 4, 8
+                CHECK(accounting::of("operator>>").bytes == (1 + 2 + 4 + 8) * sizeof(double));
+        const Matrix evaluated{lazy(right) + lazy(right)};
+                CHECK(accounting::of(accounting::OUTSIDE).allocations == 1);
+    }
+
+    accounting::enable(false);
+    const Matrix ignored{left};
+    std::stringstream report;
+    accounting::report(report);
+            CHECK(report.str().find("total") != std::string::npos);
+    accounting::reset();
+            CHECK(accounting::total().constructions == 0);
+}
+
+TEST_CASE ("Lazy expressions") {
+    Matrix mat1{{1.5, -2, 3.25, 4, 0, 6}, 2, 3};
+    Matrix mat2{{0.1, 0.2, 0.3, 0.4, 0.5, 0.6}, 2, 3};
+    Matrix mat3{{7, 8, 9, 10, 11, 12}, 2, 3};
+
+            SUBCASE("Same values as the eager operators") {
+        Matrix fused{zich::lazy(mat1) + mat2 - mat3 * 2.0};
+                CHECK(fused == mat1 + mat2 - mat3 * 2.0);
+                CHECK(Matrix{3 * (zich::lazy(mat1) - mat2)} == 3 * (mat1 - mat2));
+                CHECK(Matrix{-zich::lazy(mat3)} == -mat3);
+    }
+
+            SUBCASE("Assignment reads and writes the same matrix") {
+        Matrix res{mat1};
+        res = zich::lazy(res) * 0.5 + mat2;
+                CHECK(res == mat1 * 0.5 + mat2);
+        res += zich::lazy(mat3) * 2.0;
+                CHECK(res == mat1 * 0.5 + mat2 + mat3 * 2.0);
+        res -= zich::lazy(mat3) - mat2;
+                CHECK(res == mat1 * 0.5 + mat2 + mat3 * 2.0 - (mat3 - mat2));
+    }
+
+            SUBCASE("Dimensions are checked when the expression is built") {
+        Matrix mat4{{1, 2, 3, 4, 5, 6}, 3, 2};
+                CHECK_THROWS(zich::lazy(mat1) + mat4);
+                CHECK_THROWS(mat4 - zich::lazy(mat1) * 2.0);
+                CHECK_THROWS(mat4 += zich::lazy(mat1));
+    }
+}
+
+TEST_CASE ("Fixed-size matrices") {
+    constexpr zich::Matrix3 fixed_identity{zich::Matrix3::identity()};
+    constexpr zich::Matrix3 scaled{fixed_identity * 2.0 + fixed_identity};
+    static_assert(scaled(1, 1) == 3 && scaled(0, 1) == 0, "evaluated at compile time");
+    zich::FixedMatrix<3, 1> column{{1, 2, 3}};
+    zich::FixedMatrix<2, 3> wide{{1.5, -2, 0.25, 4, 5, -6}};
+
+            SUBCASE("Same values as zich::Matrix") {
+                CHECK((fixed_identity * column).toMatrix() == Matrix{identity, 3, 3} * Matrix{{1, 2, 3}, 3, 1});
+                CHECK((wide * fixed_identity).toMatrix() == Matrix{{1.5, -2, 0.25, 4, 5, -6}, 2, 3});
+                CHECK((-wide + wide * 3.0 - wide).toMatrix() == Matrix{{1.5, -2, 0.25, 4, 5, -6}, 2, 3});
+                CHECK(zich::Matrix3{Matrix{identity, 3, 3}} == fixed_identity);
+                CHECK_THROWS((zich::Matrix3{Matrix{{1, 2, 3}, 3, 1}}));
+    }
+
+            SUBCASE("Increment, decrement and comparison") {
+        zich::Matrix3 mat{fixed_identity};
+                CHECK(mat++ == fixed_identity);
+                CHECK(mat > fixed_identity);
+                CHECK(--mat == fixed_identity);
+                CHECK(mat <= fixed_identity);
+                CHECK(mat != scaled);
+        // compensated sums, as in zich::Matrix
+        constexpr zich::FixedMatrix<1, 3> cancelling{{1e16, 1, -1e16}};
+        static_assert(cancelling > zich::FixedMatrix<1, 3>{}, "the 1 is not lost");
+                CHECK(cancelling > zich::FixedMatrix<1, 3>{});
+                CHECK(cancelling.toMatrix() > Matrix{{0, 0, 0}, 1, 3});
+    }
+
+            SUBCASE("Output") {
+        std::stringstream stream;
+        stream << -fixed_identity;
+                CHECK(stream.str() == "[-1 0 0]\n"
+                                      "[0 -1 0]\n"
+                                      "[0 0 -1]");
+    }
+}
+
+TEST_CASE ("Views") {
+    std::vector<double> values(static_cast<uint>(6 * 8));
+    for (uint i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<double>(i % 7) * 1.5 - 4;
+    }
+    const Matrix mat{values, 6, 8};
+    const MatrixView view{mat};
+    const MatrixView top_left{view.block(0, 0, 3, 4)};
+    const MatrixView bottom_right{view.block(3, 4, 3, 4)};
+
+            SUBCASE("Selections look into the same buffer") {
+                CHECK(top_left.data() == mat.data());
+                CHECK(view.row(2).data() == mat.data() + 16);
+                CHECK(view.col(5)(4, 0) == values[4 * 8 + 5]);
+                CHECK(view.slice(1, 3, 2, 0, 4, 2)(2, 3) == values[5 * 8 + 6]);
+                CHECK(view.isContiguous());
+                CHECK_FALSE(top_left.isContiguous());
+                CHECK_THROWS(view.block(4, 0, 3, 1));
+                CHECK_THROWS(view.slice(0, 2, 0, 0, 1, 1));
+    }
+
+            SUBCASE("Operators give the same results as on copies") {
+        const Matrix left{top_left.toMatrix()};
+        const Matrix right{bottom_right.toMatrix()};
+                CHECK(top_left + bottom_right == left + right);
+                CHECK(top_left - right == left - right);
+                CHECK(-top_left == -left);
+                CHECK(2.5 * top_left == left * 2.5);
+                CHECK(top_left * view.block(0, 0, 4, 2) == left * view.block(0, 0, 4, 2).toMatrix());
+                CHECK(top_left * view.slice(1, 4, 1, 0, 4, 2) == left * view.slice(1, 4, 1, 0, 4, 2).toMatrix());
+                CHECK((top_left < bottom_right) == (left < right));
+                CHECK((top_left >= bottom_right) == (left >= right));
+                CHECK(view.slice(0, 6, 1, 1, 4, 2) != view.slice(0, 6, 1, 0, 4, 2));
+                CHECK_THROWS(top_left + view);
+                CHECK_THROWS(top_left * bottom_right);
+        std::stringstream stream;
+        stream << view.block(1, 1, 2, 2);
+                CHECK(stream.str() == "[-1 0.5]\n[0.5 2]");
+    }
+
+            SUBCASE("Compound assignment") {
+        Matrix block{top_left.toMatrix()};
+        block -= top_left;
+                CHECK(block == generateZeroMatrix(3, 4));
+        Matrix aliased{mat};
+        aliased += MatrixView{aliased}.block(0, 0, 6, 8);
+                CHECK(aliased == mat * 2);
+        Matrix square{view.block(0, 0, 4, 4).toMatrix()};
+        square *= view.block(2, 2, 4, 4);
+                CHECK(square == view.block(0, 0, 4, 4) * view.block(2, 2, 4, 4));
+    }
+}
+
+TEST_CASE ("Binary files") {
+    Matrix mat{{1.5, -2, 0.25, 1e300, -0.0, 7}, 2, 3};
+    std::stringstream stream;
+    writeBinary(stream, mat);
+    const std::string bytes{stream.str()};
+            CHECK(bytes.size() == sizeof(binary::Header) + 6 * sizeof(double));
+            CHECK(readBinary(stream) == mat);
+
+            SUBCASE("Memory mapped") {
+        const std::string path{(std::filesystem::temp_directory_path() / "cpp_ex3_matrix_test.bin").string()};
+        writeBinary(path, mat);
+        MappedMatrix mapped{path};
+                CHECK(mapped.rows() == 2);
+                CHECK(mapped.cols() == 3);
+                CHECK(reinterpret_cast<uintptr_t>(mapped.data()) % binary::DATA_ALIGNMENT == 0);
+                CHECK(mapped.toMatrix() == mat);
+        std::stringstream text;
+        text << mapped;
+                CHECK(text.str() == "[1.5 -2 0.25]\n[1e+300 0 7]");
+        MappedMatrix moved{std::move(mapped)};
+                CHECK(moved.toMatrix() == readBinary(path));
+        std::filesystem::remove(path);
+                CHECK_THROWS(MappedMatrix{path});
+    }
+
+            SUBCASE("Other byte order") {
+        std::string swapped{bytes};
+        std::reverse(swapped.begin() + 8, swapped.begin() + 12);   // version
+        std::reverse(swapped.begin() + 12, swapped.begin() + 16);  // endianness marker
+        std::reverse(swapped.begin() + 16, swapped.begin() + 20);  // element type
+        std::reverse(swapped.begin() + 20, swapped.begin() + 24);  // alignment
+        for (size_t offset = 24; offset < swapped.size(); offset += 8) { // sizes, data offset and entries
+            if (offset < 48 || offset >= 64) {
+                std::reverse(swapped.begin() + static_cast<long>(offset), swapped.begin() + static_cast<long>(offset + 8));
+            }
+        }
+        std::stringstream swapped_stream{swapped};
+                CHECK(readBinary(swapped_stream) == mat);
+    }
+
+            SUBCASE("Invalid files") {
+        std::stringstream truncated{bytes.substr(0, bytes.size() - 1)};
+                CHECK_THROWS_WITH(readBinary(truncated), "Matrix file is truncated!");
+        std::string bad_magic{bytes};
+        bad_magic[0] = 'X';
+        std::stringstream bad_magic_stream{bad_magic};
+                CHECK_THROWS_WITH(readBinary(bad_magic_stream), "Invalid matrix file!");
+        std::string bad_version{bytes};
+        bad_version[8] = 2;
+        std::stringstream bad_version_stream{bad_version};
+                CHECK_THROWS_WITH(readBinary(bad_version_stream), "Unsupported matrix file version!");
+        std::stringstream empty;
+                CHECK_THROWS(readBinary(empty));
+        std::string unaligned{bytes}; // entries at an odd offset could not be read as doubles in place
+        const uint32_t one = 1;
+        const uint64_t odd_offset = 65;
+        std::memcpy(&unaligned[20], &one, sizeof(one));
+        std::memcpy(&unaligned[40], &odd_offset, sizeof(odd_offset));
+        std::stringstream unaligned_stream{unaligned};
+                CHECK_THROWS_WITH(readBinary(unaligned_stream), "Invalid matrix file!");
+        std::string far{bytes};
+        const uint64_t far_offset = uint64_t{1} << 63; // negative as a stream size
+        std::memcpy(&far[40], &far_offset, sizeof(far_offset));
+        std::stringstream far_stream{far};
+                CHECK_THROWS_WITH(readBinary(far_stream), "Invalid matrix file!");
+        std::string past_end{bytes};
+        const uint64_t past_end_offset = 1024;
+        std::memcpy(&past_end[40], &past_end_offset, sizeof(past_end_offset));
+        std::stringstream past_end_stream{past_end};
+                CHECK_THROWS_WITH(readBinary(past_end_stream), "Matrix file is truncated!");
+    }
+
+            SUBCASE("Forged sizes do not allocate") {
+        std::string forged{bytes};
+        const uint64_t side = 46340; // 17 GB of entries, within the size limits
+        std::memcpy(&forged[24], &side, sizeof(side));
+        std::memcpy(&forged[32], &side, sizeof(side));
+        std::stringstream seekable{forged};
+                CHECK_THROWS_WITH(readBinary(seekable), "Matrix file is truncated!");
+        // a stream that cannot seek is read in bounded chunks
+        struct Pipe : std::streambuf {
+            explicit Pipe(std::string &data) {
+                setg(data.data(), data.data(), data.data() + data.size());
+            }
+        } pipe{forged};
+        std::istream unseekable{&pipe};
+                CHECK_THROWS_WITH(readBinary(unseekable), "Matrix file is truncated!");
+        std::string valid_bytes{bytes};
+        Pipe valid_pipe{valid_bytes};
+        std::istream valid{&valid_pipe};
+                CHECK(readBinary(valid) == mat);
+    }
+}
+
+TEST_CASE ("Sparse matrices") {
+    std::vector<double> values(static_cast<uint>(7 * 5), 0.0);
+    for (uint i = 0; i < values.size(); i += 3) {
+        values[i] = static_cast<double>(i % 11) - 5;
+    }
+    const Matrix dense{values, 7, 5};
+    const SparseMatrix csr{dense};
+    const SparseMatrix csc{dense, SparseMatrix::Format::CSC};
+    std::vector<double> other_values(static_cast<uint>(5 * 6));
+    for (uint i = 0; i < other_values.size(); ++i) {
+        other_values[i] = i % 4 == 0 ? static_cast<double>(i % 9) - 4 : 0;
+    }
+    const Matrix other{other_values, 5, 6};
+
+            SUBCASE("Conversions") {
+                CHECK(csr.nonZeros() == static_cast<size_t>(std::count_if(values.begin(), values.end(),
+                                                                          [](double v) { return v != 0; })));
+                CHECK(csr.toMatrix() == dense);
+                CHECK(csc.toMatrix() == dense);
+                CHECK(csr.toFormat(SparseMatrix::Format::CSC).indices() == csc.indices());
+                CHECK(csc.toFormat(SparseMatrix::Format::CSR).values() == csr.values());
+                CHECK(csr(6, 4) == dense.data()[34]);
+                CHECK(csc(3, 1) == dense.data()[16]);
+                CHECK((SparseMatrix{3, 2}.toMatrix() == generateZeroMatrix(3, 2)));
+                CHECK_THROWS(csr(7, 0));
+    }
+
+            SUBCASE("Products match the dense ones") {
+        const Matrix expected{dense * other};
+                CHECK(csr * other == expected);
+                CHECK(csc * other == expected);
+                CHECK(dense * SparseMatrix{other} == expected);
+                CHECK((dense * SparseMatrix{other, SparseMatrix::Format::CSC} == expected));
+                CHECK((csr * SparseMatrix{other}).toMatrix() == expected);
+                CHECK((csc * SparseMatrix{other, SparseMatrix::Format::CSC}).toMatrix() == expected);
+                CHECK((csr * MatrixView{other}.block(0, 1, 5, 3) == dense * MatrixView{other}.block(0, 1, 5, 3)));
+                CHECK_THROWS(csr * dense);
+                CHECK_THROWS(other * csr);
+                CHECK_THROWS(csr * csc);
+    }
+
+            SUBCASE("Text format") {
+        std::stringstream stream{"[0 2 0], [0 0 0], [-1.5 0 3]\n"};
+        SparseMatrix parsed{1, 1, SparseMatrix::Format::CSC};
+        stream >> parsed;
+                CHECK(parsed.format() == SparseMatrix::Format::CSC);
+                CHECK(parsed.nonZeros() == 3);
+                CHECK((parsed.toMatrix() == Matrix{{0, 2, 0, 0, 0, 0, -1.5, 0, 3}, 3, 3}));
+        std::stringstream out;
+        out << parsed;
+                CHECK(out.str() == "[0 2 0]\n[0 0 0]\n[-1.5 0 3]");
+        std::stringstream bad{"[1 0], [1]\n"};
+                CHECK_THROWS(bad >> parsed);
+    }
+
+            SUBCASE("Invalid structure") {
+                CHECK_THROWS((SparseMatrix{0, 3}));
+                CHECK_THROWS((SparseMatrix{SparseMatrix::Format::CSR, 2, 2, {0, 1}, {0}, {1}}));
+                CHECK_THROWS((SparseMatrix{SparseMatrix::Format::CSR, 2, 2, {0, 2, 2}, {1, 0}, {1, 1}}));
+                CHECK_THROWS((SparseMatrix{SparseMatrix::Format::CSR, 2, 2, {0, 1, 1}, {2}, {1}}));
+                CHECK_NOTHROW((SparseMatrix{SparseMatrix::Format::CSC, 2, 2, {0, 1, 2}, {1, 0}, {1, 1}}));
+    }
+}
+
 TEST_CASE ("Output stream") {
     /*
      * stringstream allows a string object to be treated as a stream (both input and output).
@@ -287,6 +1203,29 @@ TEST_CASE ("Output stream") {
         Matrix mat{{-0.0}, 1, 1};
         stream << mat;
                 CHECK(stream.str() == "[0]\n");
+    }
+
+            SUBCASE("Output 7- stream settings are respected") {
+        Matrix mat{{1.0 / 3, -2.5, 1e-7, 123456789}, 2, 2};
+        stream.precision(3);
+        stream << mat << '\n';
+        stream << std::fixed << mat;
+                CHECK(stream.str() == "[0.333 -2.5]\n"
+                                      "[1e-07 1.23e+08]\n"
+                                      "[0.333 -2.500]\n"
+                                      "[0.000 123456789.000]");
+    }
+
+            SUBCASE("Output 8- parallel formatting") {
+        std::vector<double> values(static_cast<uint>(300 * 40));
+        for (uint i = 0; i < values.size(); ++i) {
+            values[i] = static_cast<double>(i % 97) * -0.125 + 3;
+        }
+        Matrix mat{values, 300, 40};
+        std::stringstream parallel;
+        stream << mat;
+        mat.print(parallel, 4);
+                CHECK(parallel.str() == stream.str());
     }
 }
 
@@ -313,5 +1252,24 @@ TEST_CASE ("Input Stream") {
             SUBCASE("Input 4") {
         stream << "[1,]\n";
                 CHECK_THROWS(stream >> matrix);
+    }
+
+            SUBCASE("Input 5- values and separators") {
+        stream << "[1 -0.5 3.25],\t[0 10 -7], \n";
+                CHECK_NOTHROW(stream >> matrix);
+                CHECK(matrix == Matrix{{1, -0.5, 3.25, 0, 10, -7}, 2, 3});
+    }
+
+            SUBCASE("Input 6- errors are reported in the same order as before") {
+        Matrix before{matrix};
+        stream << "[1 2], [3], [x]\n[1 2], [3]\n[1\t2]\n[1e400]\n[1" << std::string(400, '0') << " 2], [1 2]\n\n";
+                CHECK_THROWS_WITH_AS(stream >> matrix, "Could not parse input!", std::runtime_error);
+                CHECK_THROWS_WITH_AS(stream >> matrix, "Invalid column dimensions!", std::runtime_error);
+                CHECK_THROWS_WITH_AS(stream >> matrix, "Error: Matrix size does not match dimensions after parsing!",
+                                     std::runtime_error);
+                CHECK_THROWS_AS(stream >> matrix, std::runtime_error);
+                CHECK_THROWS_AS(stream >> matrix, std::out_of_range);
+                CHECK_THROWS_AS(stream >> matrix, std::runtime_error);
+                CHECK(matrix == before);
     }
 }
\ No newline at end of file
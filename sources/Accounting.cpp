@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "Accounting.hpp"
+
+using std::uint64_t;
+
+namespace zich::accounting {
+
+    namespace {
+
+        struct Entry {
+            std::string name;
+            std::atomic<uint64_t> counts[FIELDS]{};
+
+            explicit Entry(const char *operation) : name(operation) {}
+
+            Counts read() const {
+                return Counts{counts[CONSTRUCTIONS].load(), counts[COPIES].load(), counts[MOVES].load(),
+                              counts[ALLOCATIONS].load(), counts[BYTES].load()};
+            }
+        };
+
+        std::mutex table_lock;
+
+        // one entry per operation name; a deque never moves its entries, so threads keep pointers to them
+        std::deque<Entry> table;
+
+        // outermost operation running on this thread
+        thread_local Entry *current = nullptr;
+
+        /*
+         * Names are string literals, so each thread caches the entry of every literal it has used
+         * and only takes the lock the first time (the same name in two files may be two literals).
+         */
+        Entry &entry(const char *operation) {
+            thread_local std::vector<std::pair<const char *, Entry *>> cache;
+            for (const auto &[name, cached] : cache) {
+                if (name == operation) {
+                    return *cached;
+                }
+            }
+            std::lock_guard<std::mutex> guard{table_lock};
+            auto found = std::find_if(table.begin(), table.end(),
+                                      [operation](const Entry &candidate) { return candidate.name == operation; });
+            Entry &result = found == table.end() ? table.emplace_back(operation) : *found;
+            cache.emplace_back(operation, &result);
+            return result;
+        }
+
+        void accumulate(Counts &sum, const Counts &counts) {
+            sum.constructions += counts.constructions;
+            sum.copies += counts.copies;
+            sum.moves += counts.moves;
+            sum.allocations += counts.allocations;
+            sum.bytes += counts.bytes;
+        }
+
+        void writeLine(std::ostream &out, const std::string &name, const Counts &counts) {
+            out << std::left << std::setw(22) << name << std::right << std::setw(14) << counts.constructions
+                << std::setw(10) << counts.copies << std::setw(10) << counts.moves << std::setw(13)
+                << counts.allocations << std::setw(16) << counts.bytes << '\n';
+        }
+
+    }
+
+    void enable(bool on) {
+        counting = on;
+    }
+
+    Counts total() {
+        std::lock_guard<std::mutex> guard{table_lock};
+        Counts sum{};
+        for (const Entry &operation : table) {
+            accumulate(sum, operation.read());
+        }
+        return sum;
+    }
+
+    Counts of(const std::string &operation) {
+        std::lock_guard<std::mutex> guard{table_lock};
+        for (const Entry &candidate : table) {
+            if (candidate.name == operation) {
+                return candidate.read();
+            }
+        }
+        return Counts{};
+    }
+
+    /*
+     * Entries stay (other threads may point to them), only their counts go back to zero.
+     */
+    void reset() {
+        std::lock_guard<std::mutex> guard{table_lock};
+        for (Entry &operation : table) {
+            for (std::atomic<uint64_t> &count : operation.counts) {
+                count = 0;
+            }
+        }
+    }
+
+    void report(std::ostream &out) {
+        std::lock_guard<std::mutex> guard{table_lock};
+        const auto old_flags = out.flags();
+        out << std::left << std::setw(22) << "operation" << std::right << std::setw(14) << "constructions"
+            << std::setw(10) << "copies" << std::setw(10) << "moves" << std::setw(13) << "allocations"
+            << std::setw(16) << "bytes" << '\n';
+        Counts sum{};
+        for (const Entry &operation : table) {
+            const Counts counts = operation.read();
+            if (counts.constructions + counts.copies + counts.moves + counts.allocations != 0) {
+                writeLine(out, operation.name, counts);
+                accumulate(sum, counts);
+            }
+        }
+        writeLine(out, "total", sum);
+        out.flags(old_flags);
+    }
+
+    bool Scope::enter(const char *operation) {
+        if (current != nullptr) {
+            return false;
+        }
+        current = &entry(operation);
+        return true;
+    }
+
+    void Scope::leave() {
+        current = nullptr;
+    }
+
+    void add(Field field, uint64_t amount) {
+        Entry &target = current != nullptr ? *current : entry(OUTSIDE);
+        target.counts[field].fetch_add(amount, std::memory_order_relaxed);
+    }
+
+}
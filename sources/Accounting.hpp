@@ -0,0 +1,137 @@
+#ifndef CPP_EX3_ACCOUNTING_HPP
+#define CPP_EX3_ACCOUNTING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+/*
+ * Counts of what Matrix operations construct, copy, move and allocate, to find hidden deep copies
+ * and to check that a hot path does not allocate:
+ *
+ *     accounting::enable();
+ *     a += b;
+ *     assert(accounting::of("operator+=").allocations == 0);
+ *
+ * Every event is charged to the outermost Matrix operator running on the thread (a + b copies a, then calls +=:
+ * both are charged to operator+), or to OUTSIDE when it happens in user code (Matrix b{a}).
+ * Allocations are the entry buffers of matrices: new matrices, copy assignments that outgrow the target,
+ * product buffers, and the growth of the buffer that operator>> fills. Scratch memory inside the kernels
+ * (GEMM packing, ThreadPool tasks) is not a matrix buffer and is not counted.
+ * Collection is off until enable() is called; disabled, each event and Scope costs one atomic load and a branch,
+ * inline.
+ */
+namespace zich::accounting {
+
+    // operation name of the events outside any Matrix operator
+    constexpr const char *OUTSIDE = "(outside operators)";
+
+    struct Counts {
+        std::uint64_t constructions; // every new matrix, copies included
+        std::uint64_t copies;        // copy constructions and assignments (also moves between resources)
+        std::uint64_t moves;         // move constructions and assignments that keep the buffer
+        std::uint64_t allocations;   // entry buffers allocated
+        std::uint64_t bytes;         // bytes of those buffers
+    };
+
+    // set by enable(), read inline by the events and Scope
+    inline std::atomic<bool> counting{false};
+
+    /**
+     * Turns counting on or off for every thread. Counts are kept until reset().
+     */
+    void enable(bool on = true);
+
+    inline bool enabled() {
+        return counting.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @return counts of every operation added up
+     */
+    Counts total();
+
+    /**
+     * @param operation name as in report(), for example "operator+", "operator*=" or OUTSIDE
+     * @return counts charged to that operation (zeros if it has none)
+     */
+    Counts of(const std::string &operation);
+
+    void reset();
+
+    /**
+     * Writes one line per operation with events, and the total.
+     */
+    void report(std::ostream &out);
+
+    /**
+     * Charges the events on this thread to an operation until destruction, unless an outer scope is active.
+     */
+    class Scope {
+    private:
+        bool _outermost;
+
+        /**
+         * @return false if an outer scope is active on this thread
+         */
+        static bool enter(const char *operation);
+
+        static void leave();
+
+    public:
+        /**
+         * @param operation string literal (only the pointer is kept)
+         */
+        explicit Scope(const char *operation) : _outermost(enabled() && enter(operation)) {}
+
+        Scope(const Scope &) = delete;
+
+        Scope &operator=(const Scope &) = delete;
+
+        ~Scope() {
+            if (_outermost) {
+                leave();
+            }
+        }
+    };
+
+    enum Field : unsigned {
+        CONSTRUCTIONS, COPIES, MOVES, ALLOCATIONS, BYTES, FIELDS
+    };
+
+    /**
+     * Adds to a count of the current operation (called by the events below while enabled).
+     */
+    void add(Field field, std::uint64_t amount);
+
+    // events, reported by Matrix
+
+    inline void constructed() {
+        if (enabled()) {
+            add(CONSTRUCTIONS, 1);
+        }
+    }
+
+    inline void copied() {
+        if (enabled()) {
+            add(COPIES, 1);
+        }
+    }
+
+    inline void moved() {
+        if (enabled()) {
+            add(MOVES, 1);
+        }
+    }
+
+    inline void allocated(std::size_t bytes) {
+        if (enabled()) {
+            add(ALLOCATIONS, 1);
+            add(BYTES, bytes);
+        }
+    }
+
+}
+#endif //CPP_EX3_ACCOUNTING_HPP
@@ -0,0 +1,662 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include "BasicMatrix.hpp"
+#include "Parser.hpp"
+#include "ThreadPool.hpp"
+
+// a * b + c stays two roundings (no FMA), so every instruction set gives the same bits, as for Matrix
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+using std::size_t;
+
+namespace zich {
+
+    namespace {
+
+        // bytes per kernel step: one AVX-512 register, two AVX2 or four SSE registers
+        constexpr size_t VECTOR_BYTES = 64;
+
+        // products with at least this many multiply-adds are split over the thread pool (by rows)
+        constexpr size_t PARALLEL_WORK = size_t{1} << 20;
+
+        constexpr size_t ROWS_PER_TASK = 16;
+
+        // cache blocking of the product: K_BLOCK rows of the right operand, N_BLOCK entries of each
+        constexpr size_t K_BLOCK = 128;
+
+        constexpr size_t N_BLOCK = 512;
+
+        constexpr size_t TRANSPOSE_BLOCK = 32;
+
+        /*
+         * The kernels compute in lanes: integers in the unsigned type of the same width, which wraps around
+         * instead of overflowing (signed overflow is undefined), complex numbers as (real, imaginary) pairs.
+         */
+        template<class T, bool = std::is_integral_v<T>>
+        struct Lanes {
+            typedef T type;
+            static constexpr size_t PER_ENTRY = 1;
+        };
+
+        template<class T>
+        struct Lanes<T, true> {
+            typedef std::make_unsigned_t<T> type;
+            static constexpr size_t PER_ENTRY = 1;
+        };
+
+        template<class T>
+        struct Lanes<std::complex<T>, false> {
+            typedef T type;
+            static constexpr size_t PER_ENTRY = 2;
+        };
+
+        template<class T>
+        using Lane = typename Lanes<T>::type;
+
+        // std::complex is layout-compatible with T[2], and signed integers may be accessed as unsigned
+        template<class T>
+        Lane<T> *lanes(T *entries) {
+            return reinterpret_cast<Lane<T> *>(entries);
+        }
+
+        template<class T>
+        const Lane<T> *lanes(const T *entries) {
+            return reinterpret_cast<const Lane<T> *>(entries);
+        }
+
+        /**
+         * Comparisons add the entries exactly (integers, in a wider type) or in double precision (float).
+         */
+        template<class T>
+        struct SumOf {
+            typedef double type;
+        };
+
+        template<>
+        struct SumOf<std::int32_t> {
+            typedef std::int64_t type;
+        };
+
+        template<>
+        struct SumOf<std::int64_t> {
+            typedef __int128 type;
+        };
+
+// ****************************************************************
+// kernel bodies (compiled for each instruction set below)
+// ****************************************************************
+
+        /*
+         * Loads and stores go through memcpy, which compiles to unaligned vector moves.
+         * The vectors are locals, never arguments or results (those change the ABI between instruction sets).
+         */
+
+        template<class L, bool SUBTRACT>
+        __attribute__((always_inline)) inline void zipBody(L *dst, const L *src, size_t size) {
+            typedef L vec __attribute__((vector_size(VECTOR_BYTES)));
+            constexpr size_t WIDTH = VECTOR_BYTES / sizeof(L);
+            size_t i = 0;
+            for (; i + WIDTH <= size; i += WIDTH) {
+                vec left, right;
+                std::memcpy(&left, dst + i, sizeof(vec));
+                std::memcpy(&right, src + i, sizeof(vec));
+                left = SUBTRACT ? left - right : left + right;
+                std::memcpy(dst + i, &left, sizeof(vec));
+            }
+            for (; i < size; ++i) {
+                dst[i] = SUBTRACT ? static_cast<L>(dst[i] - src[i]) : static_cast<L>(dst[i] + src[i]);
+            }
+        }
+
+        /**
+         * dst[i] = dst[i] * factor[i % PERIOD] + offset[i % PERIOD] for PERIOD lanes (one entry).
+         * PERIOD is 1 for real entries, and 2 for shifting complex entries by (real, imaginary).
+         */
+        template<class L, size_t PERIOD, bool SCALE>
+        __attribute__((always_inline)) inline void affineBody(L *dst, const L *factor, const L *offset,
+                                                              size_t size) {
+            typedef L vec __attribute__((vector_size(VECTOR_BYTES)));
+            constexpr size_t WIDTH = VECTOR_BYTES / sizeof(L);
+            L factors[WIDTH];
+            L offsets[WIDTH];
+            for (size_t lane = 0; lane < WIDTH; ++lane) {
+                factors[lane] = factor[lane % PERIOD];
+                offsets[lane] = offset[lane % PERIOD];
+            }
+            vec factor_vec, offset_vec;
+            std::memcpy(&factor_vec, factors, sizeof(vec));
+            std::memcpy(&offset_vec, offsets, sizeof(vec));
+            size_t i = 0;
+            for (; i + WIDTH <= size; i += WIDTH) {
+                vec values;
+                std::memcpy(&values, dst + i, sizeof(vec));
+                values = SCALE ? values * factor_vec : values + offset_vec;
+                std::memcpy(dst + i, &values, sizeof(vec));
+            }
+            for (; i < size; ++i) {
+                dst[i] = SCALE ? static_cast<L>(dst[i] * factors[i % PERIOD])
+                               : static_cast<L>(dst[i] + offsets[i % PERIOD]);
+            }
+        }
+
+        /**
+         * c[j] += a * b[j] for real lanes (one row of a product).
+         */
+        template<class L>
+        __attribute__((always_inline)) inline void axpyBody(L *c, L a, const L *b, size_t size) {
+            typedef L vec __attribute__((vector_size(VECTOR_BYTES)));
+            constexpr size_t WIDTH = VECTOR_BYTES / sizeof(L);
+            const vec factor = vec{} + a;
+            size_t i = 0;
+            for (; i + WIDTH <= size; i += WIDTH) {
+                vec sums, values;
+                std::memcpy(&sums, c + i, sizeof(vec));
+                std::memcpy(&values, b + i, sizeof(vec));
+                sums += factor * values;
+                std::memcpy(c + i, &sums, sizeof(vec));
+            }
+            for (; i < size; ++i) {
+                c[i] = static_cast<L>(c[i] + a * b[i]);
+            }
+        }
+
+        /*
+         * Complex products by the textbook formula, without the C99 Annex G recovery of infinities from NaN
+         * that operator* performs (a library call per product).
+         */
+
+        template<class F>
+        __attribute__((always_inline)) inline void complexScaleBody(F *dst, F re, F im, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                const F dst_re = dst[2 * i];
+                const F dst_im = dst[2 * i + 1];
+                dst[2 * i] = dst_re * re - dst_im * im;
+                dst[2 * i + 1] = dst_re * im + dst_im * re;
+            }
+        }
+
+        template<class F>
+        __attribute__((always_inline)) inline void complexAxpyBody(F *c, F re, F im, const F *b, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                const F b_re = b[2 * i];
+                const F b_im = b[2 * i + 1];
+                c[2 * i] += re * b_re - im * b_im;
+                c[2 * i + 1] += re * b_im + im * b_re;
+            }
+        }
+
+        template<class T>
+        __attribute__((always_inline)) inline void addEntries(T *dst, const T *src, size_t size) {
+            zipBody<Lane<T>, false>(lanes(dst), lanes(src), size * Lanes<T>::PER_ENTRY);
+        }
+
+        template<class T>
+        __attribute__((always_inline)) inline void subEntries(T *dst, const T *src, size_t size) {
+            zipBody<Lane<T>, true>(lanes(dst), lanes(src), size * Lanes<T>::PER_ENTRY);
+        }
+
+        template<class T>
+        __attribute__((always_inline)) inline void scaleEntries(T *dst, T scalar, size_t size) {
+            if constexpr (IsComplex<T>::value) {
+                complexScaleBody(lanes(dst), scalar.real(), scalar.imag(), size);
+            } else {
+                const Lane<T> factor = static_cast<Lane<T>>(scalar);
+                const Lane<T> offset = 0;
+                affineBody<Lane<T>, 1, true>(lanes(dst), &factor, &offset, size);
+            }
+        }
+
+        template<class T>
+        __attribute__((always_inline)) inline void shiftEntries(T *dst, T value, size_t size) {
+            const Lane<T> *offset = lanes(&value);
+            const Lane<T> factor[Lanes<T>::PER_ENTRY] = {};
+            affineBody<Lane<T>, Lanes<T>::PER_ENTRY, false>(lanes(dst), factor, offset,
+                                                            size * Lanes<T>::PER_ENTRY);
+        }
+
+        template<class T>
+        __attribute__((always_inline)) inline void axpyEntries(T *c, T a, const T *b, size_t size) {
+            if constexpr (IsComplex<T>::value) {
+                complexAxpyBody(lanes(c), a.real(), a.imag(), lanes(b), size);
+            } else {
+                axpyBody(lanes(c), static_cast<Lane<T>>(a), lanes(b), size);
+            }
+        }
+
+        template<class T>
+        struct Kernels {
+            const char *name;
+
+            void (*add)(T *dst, const T *src, size_t size); // dst[i] += src[i]
+            void (*sub)(T *dst, const T *src, size_t size); // dst[i] -= src[i]
+            void (*scale)(T *dst, T scalar, size_t size);   // dst[i] *= scalar
+            void (*shift)(T *dst, T value, size_t size);    // dst[i] += value
+            void (*axpy)(T *c, T a, const T *b, size_t size); // c[j] += a * b[j]
+        };
+
+        template<class T>
+        struct Baseline {
+            static void add(T *dst, const T *src, size_t size) { addEntries(dst, src, size); }
+
+            static void sub(T *dst, const T *src, size_t size) { subEntries(dst, src, size); }
+
+            static void scale(T *dst, T scalar, size_t size) { scaleEntries(dst, scalar, size); }
+
+            static void shift(T *dst, T value, size_t size) { shiftEntries(dst, value, size); }
+
+            static void axpy(T *c, T a, const T *b, size_t size) { axpyEntries(c, a, b, size); }
+        };
+
+#if defined(__x86_64__) || defined(__i386__)
+
+        template<class T>
+        struct Avx2 {
+            __attribute__((target("avx2"))) static void add(T *dst, const T *src, size_t size) {
+                addEntries(dst, src, size);
+            }
+
+            __attribute__((target("avx2"))) static void sub(T *dst, const T *src, size_t size) {
+                subEntries(dst, src, size);
+            }
+
+            __attribute__((target("avx2"))) static void scale(T *dst, T scalar, size_t size) {
+                scaleEntries(dst, scalar, size);
+            }
+
+            __attribute__((target("avx2"))) static void shift(T *dst, T value, size_t size) {
+                shiftEntries(dst, value, size);
+            }
+
+            __attribute__((target("avx2"))) static void axpy(T *c, T a, const T *b, size_t size) {
+                axpyEntries(c, a, b, size);
+            }
+        };
+
+        template<class T>
+        struct Avx512 {
+            __attribute__((target("avx512f"))) static void add(T *dst, const T *src, size_t size) {
+                addEntries(dst, src, size);
+            }
+
+            __attribute__((target("avx512f"))) static void sub(T *dst, const T *src, size_t size) {
+                subEntries(dst, src, size);
+            }
+
+            __attribute__((target("avx512f"))) static void scale(T *dst, T scalar, size_t size) {
+                scaleEntries(dst, scalar, size);
+            }
+
+            __attribute__((target("avx512f"))) static void shift(T *dst, T value, size_t size) {
+                shiftEntries(dst, value, size);
+            }
+
+            __attribute__((target("avx512f"))) static void axpy(T *c, T a, const T *b, size_t size) {
+                axpyEntries(c, a, b, size);
+            }
+        };
+
+#endif
+
+        template<class T, template<class> class Isa>
+        constexpr Kernels<T> kernelsOf(const char *name) {
+            return Kernels<T>{name, Isa<T>::add, Isa<T>::sub, Isa<T>::scale, Isa<T>::shift, Isa<T>::axpy};
+        }
+
+        template<class T>
+        const Kernels<T> &selectKernels() {
+            static const Kernels<T> baseline = kernelsOf<T, Baseline>("baseline");
+#if defined(__x86_64__) || defined(__i386__)
+            static const Kernels<T> avx2 = kernelsOf<T, Avx2>("avx2");
+            static const Kernels<T> avx512 = kernelsOf<T, Avx512>("avx512");
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f")) {
+                return avx512;
+            }
+            if (__builtin_cpu_supports("avx2")) {
+                return avx2;
+            }
+#endif
+            return baseline;
+        }
+
+        template<class T>
+        const Kernels<T> &activeKernels() {
+            static const Kernels<T> &selected = selectKernels<T>(); // CPUID is queried only once per type
+            return selected;
+        }
+
+        /**
+         * Rows [first, last) of C = A B. Every entry is summed over k in increasing order, as in the textbook
+         * loop, whatever the blocking and the thread count.
+         */
+        template<class T>
+        void multiplyRows(const T *a, const T *b, T *c, size_t first, size_t last, size_t k, size_t n) {
+            const Kernels<T> &kernels = activeKernels<T>();
+            for (size_t kk = 0; kk < k; kk += K_BLOCK) {
+                const size_t k_end = std::min(k, kk + K_BLOCK);
+                for (size_t jj = 0; jj < n; jj += N_BLOCK) {
+                    const size_t width = std::min(N_BLOCK, n - jj);
+                    for (size_t i = first; i < last; ++i) {
+                        for (size_t p = kk; p < k_end; ++p) {
+                            kernels.axpy(c + i * n + jj, a[i * k + p], b + p * n + jj, width);
+                        }
+                    }
+                }
+            }
+        }
+
+        template<class T>
+        void writeValue(std::ostream &out, T value) {
+            if constexpr (IsComplex<T>::value) {
+                writeValue(out, value.real());
+                if (value.imag() != 0) {
+                    out << (std::signbit(value.imag()) ? '-' : '+');
+                    writeValue(out, std::fabs(value.imag()));
+                    out << 'i';
+                }
+            } else if constexpr (std::is_floating_point_v<T>) {
+                out << (value == 0 ? T{0} : value); // no -0, as for Matrix
+            } else {
+                out << value;
+            }
+        }
+
+    }
+
+// *************************
+// constructors
+// *************************
+
+    template<class T>
+    BasicMatrix<T>::BasicMatrix(const std::vector<T> &matrix, int rows, int cols)
+            : BasicMatrix(matrix, rows, cols, memory::current()) {}
+
+    template<class T>
+    BasicMatrix<T>::BasicMatrix(const std::vector<T> &matrix, int rows, int cols,
+                                std::pmr::memory_resource *resource)
+            : _matrix(matrix.begin(), matrix.end(), resource), _rows(rows), _cols(cols) {
+        checkInput(_matrix.size(), _rows, _cols);
+    }
+
+    template<class T>
+    BasicMatrix<T>::BasicMatrix(const BasicMatrix &other) : BasicMatrix(other, memory::current()) {}
+
+    template<class T>
+    BasicMatrix<T>::BasicMatrix(const BasicMatrix &other, std::pmr::memory_resource *resource)
+            : _matrix(other._matrix, resource), _rows(other._rows), _cols(other._cols) {}
+
+    template<class T>
+    BasicMatrix<T>::BasicMatrix(Size size, std::pmr::memory_resource *resource)
+            : _matrix(static_cast<size_t>(size.rows) * static_cast<size_t>(size.cols), resource),
+              _rows(size.rows), _cols(size.cols) {}
+
+// *************************
+// operators
+// *************************
+
+    /*
+     * Complex entries are negated component-wise: multiplying by (-1, 0) would give inf * 0 = NaN
+     * in the other component of an infinite entry.
+     */
+    template<class T>
+    BasicMatrix<T> BasicMatrix<T>::operator-() const {
+        BasicMatrix matrix{*this};
+        if constexpr (IsComplex<T>::value) {
+            for (T &entry: matrix._matrix) {
+                entry = -entry;
+            }
+        } else {
+            activeKernels<T>().scale(matrix._matrix.data(), T(-1), matrix._matrix.size());
+        }
+        return matrix;
+    }
+
+    template<class T>
+    BasicMatrix<T> BasicMatrix<T>::operator+() const {
+        return BasicMatrix{*this};
+    }
+
+    template<class T>
+    BasicMatrix<T> BasicMatrix<T>::operator+(const BasicMatrix &other) const {
+        BasicMatrix res_matrix{*this};
+        return res_matrix += other;
+    }
+
+    template<class T>
+    BasicMatrix<T> BasicMatrix<T>::operator-(const BasicMatrix &other) const {
+        BasicMatrix res_matrix{*this};
+        return res_matrix -= other;
+    }
+
+    template<class T>
+    BasicMatrix<T> &BasicMatrix<T>::operator+=(const BasicMatrix &other) {
+        checkDimensionsEq(_rows, _cols, other._rows, other._cols);
+        activeKernels<T>().add(_matrix.data(), other._matrix.data(), _matrix.size());
+        return *this;
+    }
+
+    template<class T>
+    BasicMatrix<T> &BasicMatrix<T>::operator-=(const BasicMatrix &other) {
+        checkDimensionsEq(_rows, _cols, other._rows, other._cols);
+        activeKernels<T>().sub(_matrix.data(), other._matrix.data(), _matrix.size());
+        return *this;
+    }
+
+    template<class T>
+    bool BasicMatrix<T>::operator==(const BasicMatrix &other) const {
+        checkDimensionsEq(_rows, _cols, other._rows, other._cols);
+        return std::equal(_matrix.begin(), _matrix.end(), other._matrix.begin());
+    }
+
+    template<class T>
+    bool BasicMatrix<T>::operator!=(const BasicMatrix &other) const {
+        return !((*this) == other);
+    }
+
+    template<class T>
+    BasicMatrix<T> &BasicMatrix<T>::operator++() {
+        activeKernels<T>().shift(_matrix.data(), T(1), _matrix.size());
+        return *this;
+    }
+
+    template<class T>
+    BasicMatrix<T> &BasicMatrix<T>::operator--() {
+        activeKernels<T>().shift(_matrix.data(), T(-1), _matrix.size());
+        return *this;
+    }
+
+    template<class T>
+    BasicMatrix<T> BasicMatrix<T>::operator++(int) {
+        BasicMatrix mat_copy{*this};
+        ++(*this);
+        return mat_copy;
+    }
+
+    template<class T>
+    BasicMatrix<T> BasicMatrix<T>::operator--(int) {
+        BasicMatrix mat_copy{*this};
+        --(*this);
+        return mat_copy;
+    }
+
+    template<class T>
+    BasicMatrix<T> &BasicMatrix<T>::operator*=(T scalar) {
+        activeKernels<T>().scale(_matrix.data(), scalar, _matrix.size());
+        return *this;
+    }
+
+    template<class T>
+    BasicMatrix<T> BasicMatrix<T>::operator*(T scalar) const {
+        BasicMatrix res_mat{*this};
+        return res_mat *= scalar;
+    }
+
+    template<class T>
+    BasicMatrix<T> BasicMatrix<T>::operator*(const BasicMatrix &other) const {
+        return multiply(other, memory::current());
+    }
+
+    template<class T>
+    BasicMatrix<T> &BasicMatrix<T>::operator*=(const BasicMatrix &other) {
+        BasicMatrix product{multiply(other, resource())};
+        _matrix.swap(product._matrix); // same resource, so the swap is O(1)
+        _cols = product._cols;
+        return *this;
+    }
+
+    /**
+     * Cache-blocked row updates (c_i += a_ip b_p), split by rows over the thread pool for large products.
+     */
+    template<class T>
+    BasicMatrix<T> BasicMatrix<T>::multiply(const BasicMatrix &other, std::pmr::memory_resource *resource) const {
+        checkDimensionsMul(_cols, other._rows);
+        BasicMatrix product{{_rows, other._cols}, resource};
+        const auto m = static_cast<size_t>(_rows);
+        const auto k = static_cast<size_t>(_cols);
+        const auto n = static_cast<size_t>(other._cols);
+        const T *a = _matrix.data();
+        const T *b = other._matrix.data();
+        T *c = product._matrix.data();
+        if (m * n * k < PARALLEL_WORK || m <= ROWS_PER_TASK) {
+            multiplyRows(a, b, c, 0, m, k, n);
+        } else {
+            ThreadPool::instance().parallelFor((m + ROWS_PER_TASK - 1) / ROWS_PER_TASK, [=](size_t task) {
+                multiplyRows(a, b, c, task * ROWS_PER_TASK, std::min(m, (task + 1) * ROWS_PER_TASK), k, n);
+            });
+        }
+        return product;
+    }
+
+    template<class T>
+    BasicMatrix<T> BasicMatrix<T>::transpose() const {
+        BasicMatrix transposed{{_cols, _rows}, memory::current()};
+        const auto rows = static_cast<size_t>(_rows);
+        const auto cols = static_cast<size_t>(_cols);
+        for (size_t ii = 0; ii < rows; ii += TRANSPOSE_BLOCK) {
+            for (size_t jj = 0; jj < cols; jj += TRANSPOSE_BLOCK) {
+                for (size_t i = ii; i < std::min(rows, ii + TRANSPOSE_BLOCK); ++i) {
+                    for (size_t j = jj; j < std::min(cols, jj + TRANSPOSE_BLOCK); ++j) {
+                        transposed._matrix[j * rows + i] = _matrix[i * cols + j];
+                    }
+                }
+            }
+        }
+        return transposed;
+    }
+
+    /**
+     * Same layout as Matrix: each row in brackets, rows separated by newlines.
+     * Complex entries are printed as a+bi (the imaginary part only when it is not zero).
+     */
+    template<class T>
+    std::ostream &BasicMatrix<T>::print(std::ostream &out) const {
+        const auto rows = static_cast<size_t>(_rows);
+        const auto cols = static_cast<size_t>(_cols);
+        for (size_t i = 0; i < rows; ++i) {
+            out << '[';
+            for (size_t j = 0; j < cols; ++j) {
+                writeValue(out, _matrix[i * cols + j]);
+                if (j + 1 < cols) {
+                    out << ' ';
+                }
+            }
+            out << ']';
+            if (i + 1 < rows) {
+                out << '\n';
+            }
+        }
+        return out;
+    }
+
+    /**
+     * Same format and errors as Matrix, with the number grammar of the element type (see Parser.hpp).
+     * The matrix is left unchanged if the input is invalid.
+     */
+    template<class T>
+    std::istream &BasicMatrix<T>::read(std::istream &in) {
+        thread_local std::string str_input; // keeps its capacity between calls
+        getline(in, str_input);
+
+        std::pmr::vector<T> new_mat{_matrix.get_allocator()};
+        const parser::Shape shape = parser::scan<T>(str_input, [&new_mat](T value) { new_mat.push_back(value); });
+
+        _matrix.swap(new_mat);
+        _rows = shape.rows;
+        _cols = shape.cols;
+        return in;
+    }
+
+// *******************************************
+// private class methods
+// *******************************************
+
+    template<class T>
+    void BasicMatrix<T>::checkInput(size_t size, int rows, int cols) {
+        if (rows < 1 || cols < 1 || size != static_cast<size_t>(rows) * static_cast<size_t>(cols)) {
+            throw std::invalid_argument{"Invalid matrix size!"};
+        }
+    }
+
+    template<class T>
+    void BasicMatrix<T>::checkDimensionsMul(int mat1_cols, int mat2_rows) {
+        if (mat1_cols != mat2_rows) {
+            throw std::invalid_argument{"Invalid dimensions for matrix multiplication!"};
+        }
+    }
+
+    template<class T>
+    void BasicMatrix<T>::checkDimensionsEq(int rows1, int cols1, int rows2, int cols2) {
+        if (rows1 != rows2 || cols1 != cols2) {
+            throw std::invalid_argument{"Invalid dimensions for matrix addition or subtraction!"};
+        }
+    }
+
+    /**
+     * @return -1, 0 or 1 if the sum is smaller, equal or greater, 2 if a sum is NaN (or the entries are complex)
+     */
+    template<class T>
+    int BasicMatrix<T>::compareSums(const BasicMatrix &other) const {
+        checkDimensionsEq(_rows, _cols, other._rows, other._cols);
+        if constexpr (IsComplex<T>::value) {
+            return 2;
+        } else {
+            typedef typename SumOf<T>::type Sum;
+            Sum sum = 0;
+            Sum other_sum = 0;
+            for (size_t i = 0; i < _matrix.size(); ++i) {
+                sum += _matrix[i];
+                other_sum += other._matrix[i];
+            }
+            if (sum < other_sum) {
+                return -1;
+            }
+            if (sum > other_sum) {
+                return 1;
+            }
+            return sum == other_sum ? 0 : 2;
+        }
+    }
+
+    template
+    class BasicMatrix<float>;
+
+    template
+    class BasicMatrix<std::int32_t>;
+
+    template
+    class BasicMatrix<std::int64_t>;
+
+    template
+    class BasicMatrix<std::complex<float>>;
+
+    template
+    class BasicMatrix<std::complex<double>>;
+
+}
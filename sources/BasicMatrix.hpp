@@ -0,0 +1,194 @@
+#ifndef CPP_EX3_BASICMATRIX_HPP
+#define CPP_EX3_BASICMATRIX_HPP
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory_resource>
+#include <type_traits>
+#include <vector>
+#include "Memory.hpp"
+
+/*
+ * Matrices over other element types: float, 32 and 64-bit integers, and complex float and double.
+ * zich::Matrix is BasicMatrix<double>, an explicit specialization (Matrix.hpp) that keeps the views, lazy
+ * expressions, cached sums and tuned double kernels of the library. The other types share the template below,
+ * with the same operators, the same text format (per type, see Parser.hpp) and the same memory resources.
+ * Its kernels are compiled for every element type and instruction set (BasicMatrix.cpp), so a float matrix
+ * moves half the bytes of a double one and fits twice as many entries in a SIMD register.
+ * Integer arithmetic wraps around (two's complement) instead of overflowing.
+ * Complex numbers have no order, so complex matrices have == and != but no <, <=, > or >=.
+ */
+namespace zich {
+
+    template<class T>
+    class BasicMatrix;
+
+    template<>
+    class BasicMatrix<double>; // see Matrix.hpp
+
+    using Matrix = BasicMatrix<double>;
+
+    using FloatMatrix = BasicMatrix<float>;
+
+    using IntMatrix = BasicMatrix<std::int32_t>;
+
+    using LongMatrix = BasicMatrix<std::int64_t>;
+
+    using ComplexFloatMatrix = BasicMatrix<std::complex<float>>;
+
+    using ComplexMatrix = BasicMatrix<std::complex<double>>;
+
+    template<class T>
+    struct IsComplex : std::false_type {
+    };
+
+    template<class T>
+    struct IsComplex<std::complex<T>> : std::true_type {
+    };
+
+    template<class T>
+    class BasicMatrix {
+        static_assert(std::is_same_v<T, float> || std::is_same_v<T, std::int32_t> ||
+                      std::is_same_v<T, std::int64_t> || std::is_same_v<T, std::complex<float>> ||
+                      std::is_same_v<T, std::complex<double>>,
+                      "BasicMatrix supports float, double, int32_t, int64_t and std::complex<float or double>");
+
+    private:
+        std::pmr::vector<T> _matrix; // from memory::current() when the matrix is created, see Memory.hpp
+        int _rows;
+        int _cols;
+
+        static void checkInput(std::size_t size, int rows, int cols);
+
+        static void checkDimensionsMul(int mat1_cols, int mat2_rows);
+
+        static void checkDimensionsEq(int rows1, int cols1, int rows2, int cols2);
+
+        int compareSums(const BasicMatrix &other) const;
+
+        BasicMatrix multiply(const BasicMatrix &other, std::pmr::memory_resource *resource) const;
+
+        std::istream &read(std::istream &in);
+
+        struct Size {
+            int rows;
+            int cols;
+        };
+
+        // zero matrix, filled in place by the operators
+        BasicMatrix(Size size, std::pmr::memory_resource *resource);
+
+    public:
+        typedef T value_type;
+
+        BasicMatrix(const std::vector<T> &matrix, int rows, int cols);
+
+        BasicMatrix(const std::vector<T> &matrix, int rows, int cols, std::pmr::memory_resource *resource);
+
+        BasicMatrix(const BasicMatrix &other);
+
+        BasicMatrix(const BasicMatrix &other, std::pmr::memory_resource *resource);
+
+        BasicMatrix(BasicMatrix &&other) = default;
+
+        BasicMatrix &operator=(const BasicMatrix &other) = default;
+
+        BasicMatrix &operator=(BasicMatrix &&other) = default;
+
+        ~BasicMatrix() = default;
+
+        int rows() const { return _rows; }
+
+        int cols() const { return _cols; }
+
+        const T *data() const { return _matrix.data(); }
+
+        std::pmr::memory_resource *resource() const { return _matrix.get_allocator().resource(); }
+
+        BasicMatrix operator-() const;
+
+        BasicMatrix operator+() const;
+
+        BasicMatrix operator+(const BasicMatrix &other) const;
+
+        BasicMatrix operator-(const BasicMatrix &other) const;
+
+        BasicMatrix &operator+=(const BasicMatrix &other);
+
+        BasicMatrix &operator-=(const BasicMatrix &other);
+
+        /*
+         * Ordered by the sum of the entries, like Matrix: exact for integers, in double precision for float.
+         */
+        template<class U = T, class = std::enable_if_t<!IsComplex<U>::value>>
+        bool operator>(const BasicMatrix &other) const { return compareSums(other) == 1; }
+
+        template<class U = T, class = std::enable_if_t<!IsComplex<U>::value>>
+        bool operator>=(const BasicMatrix &other) const {
+            const int order = compareSums(other);
+            return order == 1 || (order != -1 && *this == other); // equal matrices have equal sums
+        }
+
+        template<class U = T, class = std::enable_if_t<!IsComplex<U>::value>>
+        bool operator<(const BasicMatrix &other) const { return compareSums(other) == -1; }
+
+        template<class U = T, class = std::enable_if_t<!IsComplex<U>::value>>
+        bool operator<=(const BasicMatrix &other) const {
+            const int order = compareSums(other);
+            return order == -1 || (order != 1 && *this == other);
+        }
+
+        bool operator==(const BasicMatrix &other) const;
+
+        bool operator!=(const BasicMatrix &other) const;
+
+        BasicMatrix &operator++();
+
+        BasicMatrix &operator--();
+
+        BasicMatrix operator++(int);
+
+        BasicMatrix operator--(int);
+
+        BasicMatrix &operator*=(T scalar);
+
+        BasicMatrix operator*(T scalar) const;
+
+        BasicMatrix operator*(const BasicMatrix &other) const;
+
+        BasicMatrix &operator*=(const BasicMatrix &other);
+
+        BasicMatrix transpose() const;
+
+        std::ostream &print(std::ostream &out) const;
+
+        // friend functions (defined here, so they are found for every element type)
+
+        friend BasicMatrix operator*(T scalar, const BasicMatrix &matrix) {
+            return matrix * scalar;
+        }
+
+        friend std::ostream &operator<<(std::ostream &out, const BasicMatrix &matrix) {
+            return matrix.print(out);
+        }
+
+        friend std::istream &operator>>(std::istream &in, BasicMatrix &matrix) {
+            return matrix.read(in);
+        }
+    };
+
+    // compiled once, in BasicMatrix.cpp
+    extern template class BasicMatrix<float>;
+
+    extern template class BasicMatrix<std::int32_t>;
+
+    extern template class BasicMatrix<std::int64_t>;
+
+    extern template class BasicMatrix<std::complex<float>>;
+
+    extern template class BasicMatrix<std::complex<double>>;
+
+}
+#endif //CPP_EX3_BASICMATRIX_HPP
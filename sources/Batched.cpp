@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "Batched.hpp"
+#include "ThreadPool.hpp"
+
+using std::size_t;
+
+// keep a * b + c as two roundings (no FMA) so results stay identical to Matrix::operator*
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace zich::batched {
+
+    namespace {
+
+        // interleaved groups per parallel task
+        constexpr size_t GROUPS_PER_TASK = 64;
+
+        /*
+         * LANES doubles as one GCC/Clang vector: one zmm register when compiled for AVX-512,
+         * two ymm for AVX2 and four xmm otherwise. The same body is compiled once per target below.
+         */
+        typedef double lanes __attribute__((vector_size(LANES * sizeof(double))));
+
+        struct Shape {
+            size_t m;
+            size_t k;
+            size_t n;
+        };
+
+        /**
+         * Multiplies the products of groups [first, last). Each group is interleaved into scratch buffers
+         * (element e of matrix w goes to e * LANES + w), multiplied lane-parallel and scattered back.
+         */
+        __attribute__((always_inline)) inline void runGroups(const double *a, const double *b, double *c,
+                                                             size_t batch, Shape shape, size_t first, size_t last) {
+            const size_t a_size = shape.m * shape.k;
+            const size_t b_size = shape.k * shape.n;
+            const size_t c_size = shape.m * shape.n;
+            std::vector<double> scratch((a_size + b_size + c_size) * LANES);
+            double *a_lanes = scratch.data();
+            double *b_lanes = a_lanes + a_size * LANES;
+            double *c_lanes = b_lanes + b_size * LANES;
+            for (size_t group = first; group < last; ++group) {
+                const size_t first_product = group * LANES;
+                const size_t count = std::min(LANES, batch - first_product);
+                if (count < LANES) { // the last group is padded with zero matrices
+                    std::fill(a_lanes, a_lanes + (a_size + b_size) * LANES, 0.0);
+                }
+                for (size_t w = 0; w < count; ++w) {
+                    const double *a_src = a + (first_product + w) * a_size;
+                    const double *b_src = b + (first_product + w) * b_size;
+                    for (size_t e = 0; e < a_size; ++e) {
+                        a_lanes[e * LANES + w] = a_src[e];
+                    }
+                    for (size_t e = 0; e < b_size; ++e) {
+                        b_lanes[e * LANES + w] = b_src[e];
+                    }
+                }
+                for (size_t i = 0; i < shape.m; ++i) {
+                    for (size_t j = 0; j < shape.n; ++j) {
+                        lanes acc{};
+                        for (size_t p = 0; p < shape.k; ++p) {
+                            lanes a_val;
+                            lanes b_val;
+                            std::memcpy(&a_val, a_lanes + (i * shape.k + p) * LANES, sizeof(lanes));
+                            std::memcpy(&b_val, b_lanes + (p * shape.n + j) * LANES, sizeof(lanes));
+                            acc += a_val * b_val;
+                        }
+                        std::memcpy(c_lanes + (i * shape.n + j) * LANES, &acc, sizeof(lanes));
+                    }
+                }
+                for (size_t w = 0; w < count; ++w) {
+                    double *c_dst = c + (first_product + w) * c_size;
+                    for (size_t e = 0; e < c_size; ++e) {
+                        c_dst[e] = c_lanes[e * LANES + w];
+                    }
+                }
+            }
+        }
+
+        typedef void (*GroupKernel)(const double *, const double *, double *, size_t, Shape, size_t, size_t);
+
+        void groupsBaseline(const double *a, const double *b, double *c, size_t batch, Shape shape,
+                            size_t first, size_t last) {
+            runGroups(a, b, c, batch, shape, first, last);
+        }
+
+#if defined(__x86_64__) || defined(__i386__)
+
+        __attribute__((target("avx2"))) void groupsAvx2(const double *a, const double *b, double *c, size_t batch,
+                                                        Shape shape, size_t first, size_t last) {
+            runGroups(a, b, c, batch, shape, first, last);
+        }
+
+        __attribute__((target("avx512f"))) void groupsAvx512(const double *a, const double *b, double *c,
+                                                             size_t batch, Shape shape, size_t first, size_t last) {
+            runGroups(a, b, c, batch, shape, first, last);
+        }
+
+#endif
+
+        struct Variant {
+            const char *name;
+            GroupKernel kernel;
+        };
+
+        const Variant &selectVariant() {
+            static const Variant baseline{"baseline", groupsBaseline};
+#if defined(__x86_64__) || defined(__i386__)
+            static const Variant avx2{"avx2", groupsAvx2};
+            static const Variant avx512{"avx512", groupsAvx512};
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f")) {
+                return avx512;
+            }
+            if (__builtin_cpu_supports("avx2")) {
+                return avx2;
+            }
+#endif
+            return baseline;
+        }
+
+        const Variant &activeVariant() {
+            static const Variant &selected = selectVariant(); // CPUID is queried only once
+            return selected;
+        }
+
+    }
+
+    void multiply(const double *a, const double *b, double *c, size_t batch, size_t m, size_t k, size_t n,
+                  unsigned max_threads) {
+        if (m == 0 || k == 0 || n == 0) {
+            throw std::invalid_argument{"Invalid matrix size!"};
+        }
+        const Shape shape{m, k, n};
+        const GroupKernel kernel = activeVariant().kernel;
+        const size_t groups = (batch + LANES - 1) / LANES;
+        const size_t tasks = (groups + GROUPS_PER_TASK - 1) / GROUPS_PER_TASK;
+        ThreadPool::instance().parallelFor(tasks, [=](size_t task) {
+            const size_t first = task * GROUPS_PER_TASK;
+            kernel(a, b, c, batch, shape, first, std::min(groups, first + GROUPS_PER_TASK));
+        }, max_threads);
+    }
+
+    std::vector<double> multiply(const std::vector<double> &a, const std::vector<double> &b, size_t batch,
+                                 size_t m, size_t k, size_t n, unsigned max_threads) {
+        if (a.size() != batch * m * k || b.size() != batch * k * n) {
+            throw std::invalid_argument{"Invalid matrix size!"};
+        }
+        std::vector<double> c(batch * m * n);
+        multiply(a.data(), b.data(), c.data(), batch, m, k, n, max_threads);
+        return c;
+    }
+
+    const char *variant() {
+        return activeVariant().name;
+    }
+
+}
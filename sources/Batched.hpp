@@ -0,0 +1,43 @@
+#ifndef CPP_EX3_BATCHED_HPP
+#define CPP_EX3_BATCHED_HPP
+
+#include <cstddef>
+#include <vector>
+
+/*
+ * Batched multiplication of many independent small matrices (2x2 up to 16x16) of the same shape.
+ * Groups of LANES products are interleaved so that SIMD lane w holds matrix w of the group ("batch in lanes"),
+ * then one vector instruction advances LANES products at once. This works for every shape, however small:
+ * https://www.netlib.org/utk/people/JackDongarra/PAPERS/batched-blas.pdf
+ * The instruction set is picked once at runtime (AVX-512, AVX2 or baseline), like Simd.hpp.
+ */
+namespace zich::batched {
+
+    // products per interleaved group (one AVX-512 register of doubles)
+    constexpr std::size_t LANES = 8;
+
+    /**
+     * Computes c[i] = a[i] * b[i] for i in [0, batch).
+     * a holds batch row-major (m x k) matrices back to back, b holds (k x n) ones and c receives (m x n) ones.
+     * Entries are summed in the same order as Matrix::operator*, so results match it exactly.
+     * Large batches are split across the ThreadPool.
+     * @param max_threads per-call thread cap, 0 uses the global ThreadPool limit
+     * @throws std::invalid_argument if a dimension is 0
+     */
+    void multiply(const double *a, const double *b, double *c, std::size_t batch,
+                  std::size_t m, std::size_t k, std::size_t n, unsigned max_threads = 0);
+
+    /**
+     * Same as above for vectors; checks that their sizes match batch and the dimensions.
+     * @return the batch of products
+     */
+    std::vector<double> multiply(const std::vector<double> &a, const std::vector<double> &b, std::size_t batch,
+                                 std::size_t m, std::size_t k, std::size_t n, unsigned max_threads = 0);
+
+    /**
+     * @return name of the kernel variant in use ("avx512", "avx2" or "baseline")
+     */
+    const char *variant();
+
+}
+#endif //CPP_EX3_BATCHED_HPP
@@ -0,0 +1,286 @@
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include "Counters.hpp"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using std::uint64_t;
+
+namespace zich::counters {
+
+    namespace {
+
+        std::mutex totals_lock;
+
+        Stats totals[OPERATIONS]{};
+
+        constexpr const char *OPERATION_NAMES[OPERATIONS] = {"operator*=", "operator>>", "operator<<", "add",
+                                                             "subtract", "shift", "scale"};
+
+        constexpr const char *EVENT_NAMES[EVENTS] = {"cycles", "instructions", "cache-references", "cache-misses",
+                                                     "branches", "branch-misses", "task-clock", "page-faults"};
+
+        /*
+         * One counter group per thread, opened on the first instrumented call while enabled and kept open
+         * (counting all the time) until the thread exits. Scopes read it twice and keep the difference.
+         * The leader is the first event the kernel accepts, the other events join its group
+         * so they are scheduled on the PMU together and can be read in one system call.
+         */
+        class Group {
+        private:
+            bool _opened = false;
+            int _fds[EVENTS];
+            int _slots[EVENTS]; // position of the event in a group read, -1 if unavailable
+            unsigned _members = 0;
+
+        public:
+            Group() {
+                std::fill(std::begin(_fds), std::end(_fds), -1);
+                std::fill(std::begin(_slots), std::end(_slots), -1);
+            }
+
+            Group(const Group &) = delete;
+
+            Group &operator=(const Group &) = delete;
+
+            ~Group() {
+#if defined(__linux__)
+                for (int fd : _fds) {
+                    if (fd != -1) {
+                        close(fd);
+                    }
+                }
+#endif
+            }
+
+            void open() {
+                if (_opened) {
+                    return;
+                }
+                _opened = true;
+#if defined(__linux__)
+                static const std::uint32_t TYPES[EVENTS] = {
+                        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_SOFTWARE, PERF_TYPE_SOFTWARE};
+                static const uint64_t CONFIGS[EVENTS] = {
+                        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_REFERENCES,
+                        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES,
+                        PERF_COUNT_SW_TASK_CLOCK, PERF_COUNT_SW_PAGE_FAULTS};
+                int leader = -1;
+                for (unsigned event = 0; event < EVENTS; ++event) {
+                    perf_event_attr attributes{};
+                    attributes.size = sizeof(attributes);
+                    attributes.type = TYPES[event];
+                    attributes.config = CONFIGS[event];
+                    attributes.exclude_kernel = 1; // allowed with the default perf_event_paranoid (2)
+                    attributes.exclude_hv = 1;
+                    attributes.read_format =
+                            PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+                    const long fd = syscall(SYS_perf_event_open, &attributes, 0, -1, leader, PERF_FLAG_FD_CLOEXEC);
+                    if (fd < 0) {
+                        continue;
+                    }
+                    _fds[event] = static_cast<int>(fd);
+                    _slots[event] = static_cast<int>(_members++);
+                    if (leader == -1) {
+                        leader = static_cast<int>(fd);
+                    }
+                }
+#endif
+            }
+
+            bool available(Event event) const {
+                return _slots[event] != -1;
+            }
+
+            /**
+             * values: time enabled, time running, then every event (0 if unavailable)
+             * @return false if nothing could be read
+             */
+            bool read(uint64_t *values) const {
+                std::memset(values, 0, (EVENTS + 2) * sizeof(uint64_t));
+#if defined(__linux__)
+                if (_members == 0) {
+                    return false;
+                }
+                uint64_t buffer[EVENTS + 3]; // number of events, time enabled, time running, values
+                int leader = -1;
+                for (unsigned event = 0; event < EVENTS && leader == -1; ++event) {
+                    if (_slots[event] == 0) {
+                        leader = _fds[event];
+                    }
+                }
+                const ssize_t bytes = ::read(leader, buffer, sizeof(buffer));
+                if (bytes < static_cast<ssize_t>(3 * sizeof(uint64_t)) || buffer[0] != _members) {
+                    return false;
+                }
+                values[0] = buffer[1];
+                values[1] = buffer[2];
+                for (unsigned event = 0; event < EVENTS; ++event) {
+                    if (_slots[event] != -1) {
+                        values[2 + event] = buffer[3 + static_cast<unsigned>(_slots[event])];
+                    }
+                }
+                return true;
+#else
+                return false;
+#endif
+            }
+        };
+
+        Group &group() {
+            thread_local Group thread_group;
+            thread_group.open();
+            return thread_group;
+        }
+
+        double ratio(double part, double whole) {
+            return whole > 0 ? part / whole : 0;
+        }
+
+    }
+
+    const char *name(Operation operation) {
+        return OPERATION_NAMES[operation];
+    }
+
+    const char *name(Event event) {
+        return EVENT_NAMES[event];
+    }
+
+    /*
+     * Ratios only use the calls in which both events were counted (they are in one group, so they always are).
+     */
+    double Stats::ipc() const {
+        return ratio(events[INSTRUCTIONS], events[CYCLES]);
+    }
+
+    double Stats::cacheMissRate() const {
+        return ratio(events[CACHE_MISSES], events[CACHE_REFERENCES]);
+    }
+
+    double Stats::branchMissRate() const {
+        return ratio(events[BRANCH_MISSES], events[BRANCHES]);
+    }
+
+    double Stats::gflops() const {
+        return ratio(flops, static_cast<double>(nanoseconds));
+    }
+
+    void enable(bool on) {
+        collecting = on;
+    }
+
+    bool available(Event event) {
+        return group().available(event);
+    }
+
+    Stats stats(Operation operation) {
+        std::lock_guard<std::mutex> guard{totals_lock};
+        return totals[operation];
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> guard{totals_lock};
+        std::fill(std::begin(totals), std::end(totals), Stats{});
+    }
+
+    void report(std::ostream &out) {
+        Stats all[OPERATIONS];
+        {
+            std::lock_guard<std::mutex> guard{totals_lock};
+            std::copy(std::begin(totals), std::end(totals), std::begin(all));
+        }
+        const auto old_flags = out.flags();
+        const auto old_precision = out.precision();
+        out << std::left << std::setw(12) << "operation" << std::right << std::setw(10) << "calls" << std::setw(12)
+            << "ms" << std::setw(12) << "CPU ms" << std::setw(10) << "GFLOP/s" << std::setw(10) << "GB/s"
+            << std::setw(8) << "IPC"
+            << std::setw(12) << "LLC miss %" << std::setw(14) << "branch miss %" << std::setw(13) << "page faults"
+            << '\n' << std::fixed;
+        for (unsigned operation = 0; operation < OPERATIONS; ++operation) {
+            const Stats &stats = all[operation];
+            if (stats.calls == 0) {
+                continue;
+            }
+            const double nanoseconds = static_cast<double>(stats.nanoseconds);
+            out << std::left << std::setw(12) << OPERATION_NAMES[operation] << std::right << std::setw(10)
+                << stats.calls << std::setprecision(3) << std::setw(12) << nanoseconds / 1e6;
+            const auto optional = [&out, &stats](int width, Event event, double value) {
+                if (stats.counted[event] == 0) {
+                    out << std::setw(width) << '-';
+                } else {
+                    out << std::setw(width) << value;
+                }
+            };
+            optional(12, TASK_CLOCK, stats.events[TASK_CLOCK] / 1e6);
+            out << std::setw(10) << stats.gflops() << std::setw(10) << ratio(stats.bytes, nanoseconds)
+                << std::setprecision(2);
+            optional(8, CYCLES, stats.ipc());
+            optional(12, CACHE_REFERENCES, 100 * stats.cacheMissRate());
+            optional(14, BRANCHES, 100 * stats.branchMissRate());
+            out << std::setprecision(0);
+            optional(13, PAGE_FAULTS, stats.events[PAGE_FAULTS]);
+            out << '\n';
+        }
+        out << "unavailable events:";
+        bool any = false;
+        for (unsigned event = 0; event < EVENTS; ++event) {
+            if (!available(static_cast<Event>(event))) {
+                out << ' ' << EVENT_NAMES[event];
+                any = true;
+            }
+        }
+        out << (any ? "\n" : " none\n");
+        out.flags(old_flags);
+        out.precision(old_precision);
+    }
+
+// ****************
+// Scope
+// ****************
+
+    void Scope::start() {
+        _counted = group().read(_values);
+        _start = std::chrono::steady_clock::now(); // last, so the read is not timed
+    }
+
+    /*
+     * A group that the PMU shared with other groups only counted part of the time (multiplexing):
+     * its differences are scaled by time enabled / time running, as perf stat does.
+     */
+    void Scope::finish() {
+        const auto elapsed = std::chrono::steady_clock::now() - _start;
+        uint64_t end[EVENTS + 2]{};
+        const bool counted = _counted && group().read(end);
+        const uint64_t enabled_time = counted ? end[0] - _values[0] : 0;
+        const uint64_t running_time = counted ? end[1] - _values[1] : 0;
+        const double scale =
+                running_time == 0 ? 0 : static_cast<double>(enabled_time) / static_cast<double>(running_time);
+
+        std::lock_guard<std::mutex> guard{totals_lock};
+        Stats &stats = totals[_operation];
+        ++stats.calls;
+        stats.nanoseconds += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                                                           .count());
+        stats.flops += _flops;
+        stats.bytes += _bytes;
+        if (!counted || running_time == 0) {
+            return;
+        }
+        Group &thread_group = group();
+        for (unsigned event = 0; event < EVENTS; ++event) {
+            if (thread_group.available(static_cast<Event>(event))) {
+                stats.events[event] += static_cast<double>(end[2 + event] - _values[2 + event]) * scale;
+                ++stats.counted[event];
+            }
+        }
+    }
+
+}
@@ -0,0 +1,150 @@
+#ifndef CPP_EX3_COUNTERS_HPP
+#define CPP_EX3_COUNTERS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+/*
+ * Opt-in hardware performance counters for single Matrix operations.
+ * While enabled, operator*= (and the products built on it), operator>>, operator<< and the elementwise kernels
+ * (+=, -=, ++, --, scalar *= and the operators that call them) read a perf_event_open counter group of the
+ * calling thread before and after the call, and add the difference to the statistics of that operation:
+ * https://man7.org/linux/man-pages/man2/perf_event_open.2.html
+ * Counters are per thread, so work handed to ThreadPool workers is not counted (the time is):
+ * set ThreadPool::setMaxThreads(1) for complete counts of parallel products.
+ * When the kernel refuses an event (no PMU in a virtual machine, perf_event_paranoid, another OS) that event
+ * is reported as unavailable, and calls, time and the nominal FLOPs and bytes are still collected.
+ * FLOPs are counted by the operation itself (2mkn for a product): the hardware FLOP events are model-specific.
+ * Disabled, an instrumented call costs one atomic load.
+ */
+namespace zich::counters {
+
+    enum Operation : unsigned {
+        MULTIPLY, // operator*=(Matrix) and everything built on it
+        READ,     // operator>>
+        WRITE,    // operator<< and print
+        ADD,      // +=, and + through it
+        SUBTRACT, // -=, and - through it
+        SHIFT,    // ++ and --
+        SCALE,    // scalar *=, and unary - and scalar * through it
+        OPERATIONS
+    };
+
+    enum Event : unsigned {
+        CYCLES,
+        INSTRUCTIONS,
+        CACHE_REFERENCES, // last level cache
+        CACHE_MISSES,
+        BRANCHES,
+        BRANCH_MISSES,
+        TASK_CLOCK,       // ns on the CPU (software event)
+        PAGE_FAULTS,      // software event
+        EVENTS
+    };
+
+    const char *name(Operation operation);
+
+    const char *name(Event event);
+
+    struct Stats {
+        std::uint64_t calls;
+        std::uint64_t nanoseconds; // wall time
+        double flops;              // nominal
+        double bytes;              // nominal matrix bytes read and written
+        double events[EVENTS];     // scaled for multiplexing
+        std::uint64_t counted[EVENTS]; // calls in which the event was counted
+
+        /**
+         * @return instructions per cycle, or 0 if either is unavailable
+         */
+        double ipc() const;
+
+        /**
+         * @return misses per reference (or per branch) in [0, 1], or 0 if unavailable
+         */
+        double cacheMissRate() const;
+
+        double branchMissRate() const;
+
+        double gflops() const;
+    };
+
+    // set by enable(), read inline so that a disabled Scope is one load and a branch
+    inline std::atomic<bool> collecting{false};
+
+    /**
+     * Turns collection on or off for every thread. Statistics are kept until reset().
+     */
+    void enable(bool on = true);
+
+    inline bool enabled() {
+        return collecting.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Opens the counter group of the calling thread if needed.
+     * @return true if the event can be counted on this thread
+     */
+    bool available(Event event);
+
+    /**
+     * @return statistics of one operation since the last reset
+     */
+    Stats stats(Operation operation);
+
+    void reset();
+
+    /**
+     * Writes a table of every operation that was called: calls, wall and CPU time, GFLOP/s, GB/s, IPC,
+     * miss rates and page faults ("-" where an event is unavailable), then the unavailable events.
+     */
+    void report(std::ostream &out);
+
+    /**
+     * Counts one call of an operation from construction to destruction (RAII, like std::lock_guard).
+     */
+    class Scope {
+    private:
+        Operation _operation;
+        bool _active;
+        bool _counted; // the group was read at the start
+        double _flops;
+        double _bytes;
+        std::chrono::steady_clock::time_point _start;
+        std::uint64_t _values[EVENTS + 2]; // time enabled, time running, then the events
+
+        void start();
+
+        void finish();
+
+    public:
+        /**
+         * @param flops, bytes nominal work of the call (see work() if it is only known later)
+         */
+        Scope(Operation operation, double flops, double bytes)
+                : _operation(operation), _active(enabled()), _counted(false), _flops(flops), _bytes(bytes) {
+            if (_active) {
+                start();
+            }
+        }
+
+        Scope(const Scope &) = delete;
+
+        Scope &operator=(const Scope &) = delete;
+
+        ~Scope() {
+            if (_active) {
+                finish();
+            }
+        }
+
+        void work(double flops, double bytes) {
+            _flops = flops;
+            _bytes = bytes;
+        }
+    };
+
+}
+#endif //CPP_EX3_COUNTERS_HPP
@@ -0,0 +1,233 @@
+#ifndef CPP_EX3_FIXEDMATRIX_HPP
+#define CPP_EX3_FIXEDMATRIX_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "Matrix.hpp"
+#include "Formatter.hpp"
+
+/*
+ * Matrix with dimensions known at compile time (3x3 and 4x4 transforms and the like).
+ * Entries live inline (no heap), dimension mismatches are compile errors instead of exceptions,
+ * and every loop runs over constant bounds (the elementwise ones are unrolled with index sequences):
+ * https://en.cppreference.com/w/cpp/utility/integer_sequence
+ * Values and output format are the same as zich::Matrix, and the two convert into each other.
+ */
+namespace zich {
+
+    template<std::size_t R, std::size_t C>
+    class FixedMatrix {
+        static_assert(R > 0 && C > 0, "FixedMatrix dimensions must be positive");
+
+    private:
+        std::array<double, R * C> _matrix{};
+
+        template<class Op, std::size_t... I>
+        constexpr void applyEach(Op op, std::index_sequence<I...> /*unused*/) {
+            (op(_matrix[I], I), ...);
+        }
+
+        template<class Op>
+        constexpr void applyEach(Op op) {
+            applyEach(op, std::make_index_sequence<R * C>{});
+        }
+
+        /*
+         * Compensated like reduce::sum, which zich::Matrix compares: every addition keeps its exact rounding error
+         * (TwoSum), so cancelling entries such as {1e16, 1, -1e16} still sum to 1.
+         */
+        constexpr double calculateSum() const {
+            double mat_sum = 0;
+            double error = 0;
+            for (const double value: _matrix) {
+                const double next = mat_sum + value;
+                const double value_part = next - mat_sum;
+                error += (mat_sum - (next - value_part)) + (value - value_part);
+                mat_sum = next;
+            }
+            return mat_sum - mat_sum == 0 ? mat_sum + error : mat_sum; // the error is NaN once the sum is not finite
+        }
+
+    public:
+        static constexpr std::size_t rows() { return R; }
+
+        static constexpr std::size_t cols() { return C; }
+
+        /**
+         * Zero matrix.
+         */
+        constexpr FixedMatrix() = default;
+
+        /**
+         * @param values row-major entries
+         */
+        constexpr explicit FixedMatrix(const std::array<double, R * C> &values) : _matrix(values) {}
+
+        /**
+         * Copies a dynamic matrix.
+         * @throws std::invalid_argument if its dimensions are not R x C
+         */
+        explicit FixedMatrix(const Matrix &matrix) {
+            if (static_cast<std::size_t>(matrix.rows()) != R || static_cast<std::size_t>(matrix.cols()) != C) {
+                throw std::invalid_argument{"Invalid matrix size!"};
+            }
+            for (std::size_t i = 0; i < R * C; ++i) {
+                _matrix[i] = matrix.data()[i];
+            }
+        }
+
+        static constexpr FixedMatrix identity() {
+            static_assert(R == C, "identity matrix must be square");
+            FixedMatrix matrix;
+            for (std::size_t i = 0; i < R; ++i) {
+                matrix._matrix[i * C + i] = 1;
+            }
+            return matrix;
+        }
+
+        /**
+         * @return dynamic copy with the same dimensions and values
+         */
+        Matrix toMatrix() const {
+            Matrix matrix{{static_cast<int>(R), static_cast<int>(C)}, memory::current()};
+            std::copy(_matrix.begin(), _matrix.end(), matrix._matrix.data());
+            return matrix;
+        }
+
+        explicit operator Matrix() const { return toMatrix(); }
+
+        constexpr double operator()(std::size_t row, std::size_t col) const { return _matrix[row * C + col]; }
+
+        constexpr double &operator()(std::size_t row, std::size_t col) { return _matrix[row * C + col]; }
+
+        constexpr const std::array<double, R * C> &values() const { return _matrix; }
+
+        constexpr FixedMatrix &operator+=(const FixedMatrix &other) {
+            applyEach([&other](double &val, std::size_t i) { val += other._matrix[i]; });
+            return *this;
+        }
+
+        constexpr FixedMatrix &operator-=(const FixedMatrix &other) {
+            applyEach([&other](double &val, std::size_t i) { val -= other._matrix[i]; });
+            return *this;
+        }
+
+        constexpr FixedMatrix &operator*=(double scalar) {
+            applyEach([scalar](double &val, std::size_t /*unused*/) { val *= scalar; });
+            return *this;
+        }
+
+        constexpr FixedMatrix operator+(const FixedMatrix &other) const {
+            FixedMatrix res_matrix{*this};
+            return res_matrix += other;
+        }
+
+        constexpr FixedMatrix operator-(const FixedMatrix &other) const {
+            FixedMatrix res_matrix{*this};
+            return res_matrix -= other;
+        }
+
+        constexpr FixedMatrix operator+() const { return *this; }
+
+        constexpr FixedMatrix operator-() const {
+            FixedMatrix res_matrix{*this};
+            return res_matrix *= -1;
+        }
+
+        constexpr FixedMatrix operator*(double scalar) const {
+            FixedMatrix res_matrix{*this};
+            return res_matrix *= scalar;
+        }
+
+        friend constexpr FixedMatrix operator*(double scalar, const FixedMatrix &matrix) {
+            return matrix * scalar;
+        }
+
+        /**
+         * (R x C) * (C x N): the inner dimensions match by construction.
+         * Entries are summed in the same order as Matrix::operator*, so results are identical.
+         */
+        template<std::size_t N>
+        constexpr FixedMatrix<R, N> operator*(const FixedMatrix<C, N> &other) const {
+            FixedMatrix<R, N> res_matrix;
+            for (std::size_t i = 0; i < R; ++i) {
+                for (std::size_t j = 0; j < N; ++j) {
+                    double curr_sum = 0;
+                    for (std::size_t k = 0; k < C; ++k) {
+                        curr_sum += (*this)(i, k) * other(k, j);
+                    }
+                    res_matrix(i, j) = curr_sum;
+                }
+            }
+            return res_matrix;
+        }
+
+        /**
+         * Only square matrices keep their type after multiplication.
+         */
+        constexpr FixedMatrix &operator*=(const FixedMatrix<C, C> &other) {
+            return *this = *this * other;
+        }
+
+        constexpr FixedMatrix &operator++() {
+            applyEach([](double &val, std::size_t /*unused*/) { ++val; });
+            return *this;
+        }
+
+        constexpr FixedMatrix &operator--() {
+            applyEach([](double &val, std::size_t /*unused*/) { --val; });
+            return *this;
+        }
+
+        constexpr FixedMatrix operator++(int) {
+            FixedMatrix mat_copy{*this};
+            ++(*this);
+            return mat_copy;
+        }
+
+        constexpr FixedMatrix operator--(int) {
+            FixedMatrix mat_copy{*this};
+            --(*this);
+            return mat_copy;
+        }
+
+        constexpr bool operator==(const FixedMatrix &other) const {
+            for (std::size_t i = 0; i < R * C; ++i) {
+                if (_matrix[i] != other._matrix[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        constexpr bool operator!=(const FixedMatrix &other) const { return !(*this == other); }
+
+        // ordering compares the sums of the entries, like zich::Matrix
+
+        constexpr bool operator<(const FixedMatrix &other) const { return calculateSum() < other.calculateSum(); }
+
+        constexpr bool operator>(const FixedMatrix &other) const { return calculateSum() > other.calculateSum(); }
+
+        constexpr bool operator<=(const FixedMatrix &other) const { return *this < other || *this == other; }
+
+        constexpr bool operator>=(const FixedMatrix &other) const { return *this > other || *this == other; }
+
+        /**
+         * Same format as zich::Matrix: each row in brackets, rows separated by newlines, -0 printed as 0.
+         */
+        friend std::ostream &operator<<(std::ostream &out, const FixedMatrix &matrix) {
+            formatter::write(out, matrix._matrix.data(), R, C);
+            return out;
+        }
+    };
+
+    using Matrix3 = FixedMatrix<3, 3>;
+    using Matrix4 = FixedMatrix<4, 4>;
+
+}
+#endif //CPP_EX3_FIXEDMATRIX_HPP
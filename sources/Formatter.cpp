@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <charconv>
+#include <locale>
+#include <string>
+#include <vector>
+#include "Formatter.hpp"
+#include "ThreadPool.hpp"
+
+using std::size_t;
+
+namespace zich::formatter {
+
+    namespace {
+
+        // text collected before each write to the stream
+        constexpr size_t CHUNK_SIZE = size_t{1} << 16;
+        // approximate text size of one row block in parallel mode
+        constexpr size_t BLOCK_SIZE = size_t{1} << 20;
+        // larger precisions are rare enough to go through the stream
+        constexpr std::streamsize MAX_FAST_PRECISION = 64;
+        // longest %g text is the precision plus sign, point, leading "0.000" or exponent
+        constexpr size_t EXTRA_CHARS = 16;
+
+        /**
+         * Strided row-major block.
+         */
+        struct Block {
+            const double *data;
+            size_t rows;
+            size_t cols;
+            size_t row_stride;
+            size_t col_stride;
+        };
+
+        /**
+         * Appends "[v1 v2 ... vn]" to text.
+         */
+        void appendRow(std::string &text, const double *row, size_t cols, size_t col_stride, int precision) {
+            const size_t max_value_size = static_cast<size_t>(precision) + EXTRA_CHARS;
+            const size_t old_size = text.size();
+            text.resize(old_size + cols * (max_value_size + 1) + 1);
+            char *pos = text.data() + old_size;
+            char *const end = text.data() + text.size();
+            *pos++ = '[';
+            for (size_t j = 0; j < cols; ++j) {
+                // floating point signbit could be negative and print -0 (even though 0 == -0)
+                const double curr_val = row[j * col_stride] == 0 ? 0 : row[j * col_stride];
+                pos = std::to_chars(pos, end, curr_val, std::chars_format::general, precision).ptr;
+                *pos++ = j < cols - 1 ? ' ' : ']';
+            }
+            text.resize(static_cast<size_t>(pos - text.data()));
+        }
+
+        /**
+         * Appends rows [first, last), each followed by a newline except the last row of the matrix.
+         */
+        void appendRows(std::string &text, const Block &block, size_t first, size_t last, int precision) {
+            for (size_t i = first; i < last; ++i) {
+                appendRow(text, block.data + i * block.row_stride, block.cols, block.col_stride, precision);
+                if (i < block.rows - 1) {
+                    text.push_back('\n');
+                }
+            }
+        }
+
+        void writeText(std::ostream &out, const std::string &text) {
+            out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        }
+
+        void writeSerial(std::ostream &out, const Block &block, int precision) {
+            thread_local std::string text; // keeps its capacity between calls
+            text.clear();
+            for (size_t i = 0; i < block.rows; ++i) {
+                appendRows(text, block, i, i + 1, precision);
+                if (text.size() >= CHUNK_SIZE) {
+                    writeText(out, text);
+                    text.clear();
+                }
+            }
+            writeText(out, text);
+            text.clear();
+        }
+
+        /**
+         * Formats row blocks on up to `threads` threads, one wave of blocks at a time, and writes them in order.
+         */
+        void writeParallel(std::ostream &out, const Block &block, int precision, unsigned threads) {
+            const size_t row_size = block.cols * (static_cast<size_t>(precision) + 8);
+            const size_t block_rows = std::max<size_t>(1, BLOCK_SIZE / row_size);
+            const size_t blocks = (block.rows + block_rows - 1) / block_rows;
+            std::vector<std::string> texts(std::min<size_t>(blocks, threads));
+            for (size_t wave_start = 0; wave_start < blocks; wave_start += texts.size()) {
+                const size_t wave_size = std::min(texts.size(), blocks - wave_start);
+                ThreadPool::instance().parallelFor(wave_size, [&](size_t i) {
+                    const size_t first = (wave_start + i) * block_rows;
+                    texts[i].clear();
+                    appendRows(texts[i], block, first, std::min(block.rows, first + block_rows), precision);
+                }, threads);
+                for (size_t i = 0; i < wave_size; ++i) {
+                    writeText(out, texts[i]);
+                }
+            }
+        }
+
+        /**
+         * Original element by element output, used when the stream has custom formatting.
+         */
+        void writeStream(std::ostream &out, const Block &block) {
+            for (size_t i = 0; i < block.rows; ++i) {
+                out << "[";
+                for (size_t j = 0; j < block.cols; ++j) {
+                    const double value = block.data[i * block.row_stride + j * block.col_stride];
+                    const double curr_val = value == 0 ? 0 : value;
+                    out << curr_val;
+                    if (j < block.cols - 1) {
+                        out << " ";
+                    }
+                }
+                out << "]";
+                if (i < block.rows - 1) {
+                    out << '\n';
+                }
+            }
+        }
+
+    }
+
+    bool fastPathApplies(const std::ostream &out) {
+        const std::ios_base::fmtflags formatting =
+                std::ios_base::floatfield | std::ios_base::showpos | std::ios_base::showpoint | std::ios_base::uppercase;
+        return (out.flags() & formatting) == 0 && out.width() == 0 &&
+               out.precision() >= 0 && out.precision() <= MAX_FAST_PRECISION &&
+               out.getloc() == std::locale::classic();
+    }
+
+    void write(std::ostream &out, const double *data, size_t rows, size_t cols, unsigned max_threads) {
+        write(out, data, rows, cols, cols, 1, max_threads);
+    }
+
+    void write(std::ostream &out, const double *data, size_t rows, size_t cols, size_t row_stride, size_t col_stride,
+               unsigned max_threads) {
+        if (rows == 0 || cols == 0) {
+            return;
+        }
+        const Block block{data, rows, cols, row_stride, col_stride};
+        if (!fastPathApplies(out)) {
+            writeStream(out, block);
+            return;
+        }
+        const auto precision = static_cast<int>(out.precision());
+        const unsigned threads = ThreadPool::threadLimit(max_threads);
+        if (threads <= 1 || rows * cols * static_cast<size_t>(precision + 8) <= BLOCK_SIZE) {
+            writeSerial(out, block, precision);
+        } else {
+            writeParallel(out, block, precision, threads);
+        }
+    }
+
+}
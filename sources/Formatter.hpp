@@ -0,0 +1,37 @@
+#ifndef CPP_EX3_FORMATTER_HPP
+#define CPP_EX3_FORMATTER_HPP
+
+#include <cstddef>
+#include <iostream>
+
+/*
+ * Bulk text output in the operator<< format: each row in brackets, values separated by spaces,
+ * rows separated by newlines (none after the last one) and -0 printed as 0.
+ * Rows are rendered with std::to_chars into a reusable buffer and written to the stream in large chunks:
+ * https://en.cppreference.com/w/cpp/utility/to_chars
+ * to_chars in general format with the stream precision gives the same text as `out << value` (printf %g),
+ * so this is only used while the stream has default flags, no width and the classic locale.
+ * Otherwise every value goes through `out <<` as before.
+ */
+namespace zich::formatter {
+
+    /**
+     * @return true if to_chars reproduces `out << double` for this stream's current settings
+     */
+    bool fastPathApplies(const std::ostream &out);
+
+    /**
+     * Writes a row-major (rows x cols) matrix.
+     * @param max_threads threads formatting row blocks in parallel (blocks are still written in order),
+     *                    1 = serial, 0 = global ThreadPool limit
+     */
+    void write(std::ostream &out, const double *data, std::size_t rows, std::size_t cols, unsigned max_threads = 1);
+
+    /**
+     * Same for a strided block: entry (i, j) is data[i * row_stride + j * col_stride].
+     */
+    void write(std::ostream &out, const double *data, std::size_t rows, std::size_t cols, std::size_t row_stride,
+               std::size_t col_stride, unsigned max_threads = 1);
+
+}
+#endif //CPP_EX3_FORMATTER_HPP
@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "Gemm.hpp"
+#include "ThreadPool.hpp"
+
+using std::size_t;
+
+namespace zich::gemm {
+
+    namespace {
+
+        // below this many multiply-adds packing costs more than it saves
+        constexpr size_t SMALL_PRODUCT = 32 * 32 * 32;
+
+        // below this many multiply-adds waking other threads costs more than it saves
+        constexpr size_t PARALLEL_PRODUCT = 128 * 128 * 128;
+
+        // columns of C per parallel task (a multiple of NR)
+        constexpr size_t TILE_N = 512;
+
+        /**
+         * Packs an (mc x kc) block of A into MR-row panels.
+         * Panel layout: for each k, MR consecutive row values (zero padded past mc).
+         */
+        void packA(const Operand &a, size_t row0, size_t col0, size_t mc, size_t kc, double *packed) {
+            for (size_t ir = 0; ir < mc; ir += MR) {
+                const size_t rows = std::min(MR, mc - ir);
+                for (size_t p = 0; p < kc; ++p) {
+                    const double *src = a.data + (row0 + ir) * a.row_stride + (col0 + p) * a.col_stride;
+                    for (size_t i = 0; i < rows; ++i) {
+                        packed[i] = src[i * a.row_stride];
+                    }
+                    for (size_t i = rows; i < MR; ++i) {
+                        packed[i] = 0;
+                    }
+                    packed += MR;
+                }
+            }
+        }
+
+        /**
+         * Packs a (kc x nc) panel of B into NR-column slivers.
+         * Sliver layout: for each k, NR consecutive column values (zero padded past nc).
+         */
+        void packB(const Operand &b, size_t row0, size_t col0, size_t kc, size_t nc, double *packed) {
+            for (size_t jr = 0; jr < nc; jr += NR) {
+                const size_t cols = std::min(NR, nc - jr);
+                for (size_t p = 0; p < kc; ++p) {
+                    const double *src = b.data + (row0 + p) * b.row_stride + (col0 + jr) * b.col_stride;
+                    for (size_t j = 0; j < cols; ++j) {
+                        packed[j] = src[j * b.col_stride];
+                    }
+                    for (size_t j = cols; j < NR; ++j) {
+                        packed[j] = 0;
+                    }
+                    packed += NR;
+                }
+            }
+        }
+
+        /*
+         * GCC/Clang vector extensions: https://gcc.gnu.org/onlinedocs/gcc/Vector-Extensions.html
+         * Two doubles per register works on every x86-64 (SSE2) without extra compiler flags.
+         */
+        typedef double vec2 __attribute__((vector_size(2 * sizeof(double))));
+        constexpr size_t LANES = 2;
+        constexpr size_t NV = NR / LANES; // vector registers per row of the tile
+
+        inline vec2 load(const double *src) {
+            vec2 val;
+            std::memcpy(&val, src, sizeof(val)); // unaligned load
+            return val;
+        }
+
+        inline void store(double *dst, vec2 val) {
+            std::memcpy(dst, &val, sizeof(val));
+        }
+
+        /**
+         * Register microkernel: C[MR x NR] += Ap * Bp over kc steps.
+         * The accumulators start from the current C values, so splitting k into KC blocks
+         * keeps the summation order of every entry unchanged.
+         */
+        void microKernel(size_t kc, const double *a_panel, const double *b_sliver, double *c, size_t ldc) {
+            vec2 acc[MR][NV];
+            for (size_t i = 0; i < MR; ++i) {
+                for (size_t v = 0; v < NV; ++v) {
+                    acc[i][v] = load(c + i * ldc + v * LANES);
+                }
+            }
+            for (size_t p = 0; p < kc; ++p) {
+                vec2 b_vals[NV];
+                for (size_t v = 0; v < NV; ++v) {
+                    b_vals[v] = load(b_sliver + v * LANES);
+                }
+                for (size_t i = 0; i < MR; ++i) {
+                    const vec2 a_val = vec2{} + a_panel[i]; // broadcast
+                    for (size_t v = 0; v < NV; ++v) {
+                        acc[i][v] += a_val * b_vals[v];
+                    }
+                }
+                a_panel += MR;
+                b_sliver += NR;
+            }
+            for (size_t i = 0; i < MR; ++i) {
+                for (size_t v = 0; v < NV; ++v) {
+                    store(c + i * ldc + v * LANES, acc[i][v]);
+                }
+            }
+        }
+
+        /**
+         * Multiplies the packed blocks into the (mc x nc) block of C, going through a scratch tile on the edges.
+         */
+        void macroKernel(size_t mc, size_t nc, size_t kc, const double *a_packed, const double *b_packed,
+                         double *c, size_t ldc) {
+            double edge[MR * NR];
+            for (size_t jr = 0; jr < nc; jr += NR) {
+                const size_t cols = std::min(NR, nc - jr);
+                const double *b_sliver = b_packed + jr * kc;
+                for (size_t ir = 0; ir < mc; ir += MR) {
+                    const size_t rows = std::min(MR, mc - ir);
+                    const double *a_panel = a_packed + ir * kc;
+                    double *c_tile = c + ir * ldc + jr;
+                    if (rows == MR && cols == NR) {
+                        microKernel(kc, a_panel, b_sliver, c_tile, ldc);
+                        continue;
+                    }
+                    std::fill(edge, edge + MR * NR, 0.0);
+                    for (size_t i = 0; i < rows; ++i) {
+                        std::copy(c_tile + i * ldc, c_tile + i * ldc + cols, edge + i * NR);
+                    }
+                    microKernel(kc, a_panel, b_sliver, edge, NR);
+                    for (size_t i = 0; i < rows; ++i) {
+                        std::copy(edge + i * NR, edge + i * NR + cols, c_tile + i * ldc);
+                    }
+                }
+            }
+        }
+
+        /**
+         * Unpacked i-p-j loop for tiny products (keeps the same per-entry summation order).
+         */
+        void multiplySmall(const Operand &a, const Operand &b, double *c, size_t ldc, size_t m, size_t k, size_t n) {
+            for (size_t i = 0; i < m; ++i) {
+                double *c_row = c + i * ldc;
+                for (size_t p = 0; p < k; ++p) {
+                    const double a_val = a.data[i * a.row_stride + p * a.col_stride];
+                    const double *b_row = b.data + p * b.row_stride;
+                    for (size_t j = 0; j < n; ++j) {
+                        c_row[j] += a_val * b_row[j * b.col_stride];
+                    }
+                }
+            }
+        }
+
+        // packing buffers are reused between calls on the same thread
+        thread_local std::vector<double> a_packed;
+        thread_local std::vector<double> b_packed;
+
+        void reservePacking(size_t nc) {
+            a_packed.resize(MC * KC);
+            b_packed.resize(KC * ((nc + NR - 1) / NR) * NR);
+        }
+
+        /**
+         * Single-threaded driver: each KC x NC panel of B is packed once and reused for all row blocks.
+         */
+        void multiplySerial(const Operand &a, const Operand &b, double *c, size_t ldc, size_t m, size_t k, size_t n) {
+            reservePacking(std::min(NC, n));
+            for (size_t jc = 0; jc < n; jc += NC) {
+                const size_t nc = std::min(NC, n - jc);
+                for (size_t pc = 0; pc < k; pc += KC) {
+                    const size_t kc = std::min(KC, k - pc);
+                    packB(b, pc, jc, kc, nc, b_packed.data());
+                    for (size_t ic = 0; ic < m; ic += MC) {
+                        const size_t mc = std::min(MC, m - ic);
+                        packA(a, ic, pc, mc, kc, a_packed.data());
+                        macroKernel(mc, nc, kc, a_packed.data(), b_packed.data(), c + ic * ldc + jc, ldc);
+                    }
+                }
+            }
+        }
+
+        /**
+         * Computes the (mc x nc) block of C starting at (ic, jc), used as one parallel task.
+         */
+        void multiplyTile(const Operand &a, const Operand &b, double *c, size_t ldc,
+                          size_t ic, size_t mc, size_t jc, size_t nc, size_t k) {
+            reservePacking(nc);
+            for (size_t pc = 0; pc < k; pc += KC) {
+                const size_t kc = std::min(KC, k - pc);
+                packB(b, pc, jc, kc, nc, b_packed.data());
+                packA(a, ic, pc, mc, kc, a_packed.data());
+                macroKernel(mc, nc, kc, a_packed.data(), b_packed.data(), c + ic * ldc + jc, ldc);
+            }
+        }
+
+    }
+
+    void multiply(Operand a, Operand b, double *c, size_t ldc, size_t m, size_t k, size_t n, unsigned max_threads) {
+        for (size_t i = 0; i < m; ++i) {
+            std::fill(c + i * ldc, c + i * ldc + n, 0.0);
+        }
+        if (m * n * k <= SMALL_PRODUCT) {
+            multiplySmall(a, b, c, ldc, m, k, n);
+            return;
+        }
+        const unsigned threads = m * n * k < PARALLEL_PRODUCT ? 1 : ThreadPool::threadLimit(max_threads);
+        if (threads == 1) {
+            multiplySerial(a, b, c, ldc, m, k, n);
+            return;
+        }
+        // every task owns one MC x TILE_N block of C and runs the whole k loop for it,
+        // so the per-entry summation order does not depend on the number of threads
+        const size_t row_tiles = (m + MC - 1) / MC;
+        const size_t col_tiles = (n + TILE_N - 1) / TILE_N;
+        static const bool registered = (ThreadPool::instance().releaseWhenIdle(releaseScratch), true);
+        static_cast<void>(registered);
+        ThreadPool::instance().parallelFor(row_tiles * col_tiles, [&](size_t tile) {
+            const size_t ic = (tile / col_tiles) * MC;
+            const size_t jc = (tile % col_tiles) * TILE_N;
+            multiplyTile(a, b, c, ldc, ic, std::min(MC, m - ic), jc, std::min(TILE_N, n - jc), k);
+        }, threads);
+    }
+
+    void multiply(const double *a, const double *b, double *c, size_t m, size_t k, size_t n, unsigned max_threads) {
+        multiply(Operand{a, k, 1}, Operand{b, n, 1}, c, n, m, k, n, max_threads);
+    }
+
+    void releaseScratch() {
+        std::vector<double>{}.swap(a_packed);
+        std::vector<double>{}.swap(b_packed);
+    }
+
+}
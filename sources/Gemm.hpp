@@ -0,0 +1,55 @@
+#ifndef CPP_EX3_GEMM_HPP
+#define CPP_EX3_GEMM_HPP
+
+#include <cstddef>
+
+/*
+ * Packed, cache-blocked matrix multiplication (GEMM) used by Matrix::operator*=.
+ * The loop structure follows the BLIS/GotoBLAS design:
+ * https://www.cs.utexas.edu/~flame/pubs/blis3_ipdps14.pdf
+ * https://www.cs.utexas.edu/~pingali/CS378/2008sp/papers/gotoPaper.pdf
+ */
+namespace zich::gemm {
+
+    // register tile (microkernel) dimensions
+    constexpr std::size_t MR = 8;
+    constexpr std::size_t NR = 4;
+
+    // cache blocking: KC x NR sliver of B in L1, MC x KC block of A in L2, KC x NC panel of B in L3
+    constexpr std::size_t KC = 256;
+    constexpr std::size_t MC = 96;
+    constexpr std::size_t NC = 2048;
+
+    /**
+     * Strided read-only operand. Element (i, j) is at data[i * row_stride + j * col_stride].
+     */
+    struct Operand {
+        const double *data;
+        std::size_t row_stride;
+        std::size_t col_stride;
+    };
+
+    /**
+     * Computes C = A * B where A is (m x k), B is (k x n) and C is a row-major (m x n) buffer with leading dimension ldc.
+     * C is overwritten. Every entry is accumulated in increasing k order starting from 0,
+     * so the result is identical to the textbook triple loop (for any number of threads).
+     * Large products are split into output tiles on the shared ThreadPool.
+     * @param max_threads per-call thread cap, 0 uses the global ThreadPool limit
+     */
+    void multiply(Operand a, Operand b, double *c, std::size_t ldc, std::size_t m, std::size_t k, std::size_t n,
+                  unsigned max_threads = 0);
+
+    /**
+     * Convenience overload for contiguous row-major operands.
+     */
+    void multiply(const double *a, const double *b, double *c, std::size_t m, std::size_t k, std::size_t n,
+                  unsigned max_threads = 0);
+
+    /**
+     * Frees the packing buffers of the calling thread (they are otherwise kept for its next product).
+     * ThreadPool workers call it when they go idle.
+     */
+    void releaseScratch();
+
+}
+#endif //CPP_EX3_GEMM_HPP
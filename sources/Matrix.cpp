@@ -1,13 +1,50 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <regex>
+#include <algorithm>
 #include "Matrix.hpp"
+#include "MatrixView.hpp"
+#include "Parser.hpp"
+#include "Accounting.hpp"
+#include "Counters.hpp"
+#include "Trace.hpp"
+#include "Formatter.hpp"
+#include "Simd.hpp"
+#include "Structure.hpp"
+#include "ThreadPool.hpp"
+#include "Transpose.hpp"
 
 typedef unsigned int uint;
 
+// bytes of one entry, for the nominal work reported to counters::Scope and trace spans
+constexpr double ENTRY = sizeof(double);
+
+static double entries(int rows, int cols) {
+    return static_cast<double>(rows) * static_cast<double>(cols);
+}
+
+// nominal work of a (rows x inner) * (inner x cols) product
+static double productFlops(int rows, int inner, int cols) {
+    return 2 * entries(rows, inner) * cols;
+}
+
+static double productBytes(int rows, int inner, int cols) {
+    return ENTRY * (entries(rows, inner) + entries(inner, cols) + entries(rows, cols));
+}
+
+/*
+ * Every operator is traced (Trace.hpp), and what it constructs, copies and allocates is accounted to it
+ * (Accounting.hpp), under the same name.
+ */
+#define MATRIX_OPERATION_NAME(name, ...) name
+#define MATRIX_OPERATION(...) \
+    ZICH_TRACE(__VA_ARGS__); \
+    const accounting::Scope accounting_scope{MATRIX_OPERATION_NAME(__VA_ARGS__)}
+
+// largest product buffer (in doubles) kept alive per thread for reuse by operator*=
+constexpr size_t MAX_SCRATCH_SIZE = size_t{1} << 22;
+
 using std::string;
-using std::vector;
 
 namespace zich {
 
@@ -15,67 +52,207 @@ namespace zich {
      * About constructors:
      * Matrix matrix{*this}; calls copy constructor
      * Matrix matrix{_matrix, _rows, _cols}; calls lvalue constructor
-     * Matrix matrix{{...}, (rows), (cols)}; calls move constructor
+     * Matrix matrix{{...}, (rows), (cols)}; calls rvalue constructor, which also copies the values
+     * (the vector's allocator cannot be adopted by the pmr buffer)
+     * Results built by the library are written straight into the buffer of a new matrix (private constructors).
      */
 
     /**
      * Lvalue constructor.
      */
-    Matrix::Matrix(const std::vector<double> &matrix, int rows, int cols)
-            : _matrix(matrix), _rows(rows), _cols(cols) { checkInput(_matrix.size(), _rows, _cols); }
+    Matrix::BasicMatrix(const std::vector<double> &matrix, int rows, int cols)
+            : _matrix(matrix.begin(), matrix.end(), memory::current()), _rows(rows), _cols(cols) {
+        checkInput(_matrix.size(), _rows, _cols);
+        accounting::constructed();
+        accounting::allocated(_matrix.size() * sizeof(double));
+    }
+
+    /**
+     * Constructor for rvalue vectors.
+     * The values are copied into a buffer from memory::current(): a std::vector cannot hand its memory
+     * to another allocator.
+     */
+    Matrix::BasicMatrix(std::vector<double> &&matrix, int rows, int cols) // rvalue reference
+            : BasicMatrix(static_cast<const std::vector<double> &>(matrix), rows, cols) {}
+
+    /**
+     * Copy constructor.
+     */
+    Matrix::BasicMatrix(const Matrix &other) : BasicMatrix(other, memory::current()) {}
+
+    Matrix::BasicMatrix(const Matrix &other, std::pmr::memory_resource *resource)
+            : _matrix(other._matrix, resource), _rows(other._rows), _cols(other._cols), _sum(other._sum) {
+        accounting::constructed();
+        accounting::copied();
+        accounting::allocated(_matrix.size() * sizeof(double));
+    }
+
+    /**
+     * Move constructor: takes the buffer (and its resource).
+     */
+    Matrix::BasicMatrix(Matrix &&other) noexcept
+            : _matrix(std::move(other._matrix)), _rows(other._rows), _cols(other._cols), _sum(other._sum) {
+        accounting::constructed();
+        accounting::moved();
+    }
+
+    Matrix::BasicMatrix(Size size, std::pmr::memory_resource *resource)
+            : _matrix(static_cast<size_t>(size.rows) * static_cast<size_t>(size.cols), resource),
+              _rows(size.rows), _cols(size.cols) {
+        accounting::constructed();
+        accounting::allocated(_matrix.size() * sizeof(double));
+    }
+
+    Matrix::BasicMatrix(memory::Buffer &&matrix, Size size)
+            : _matrix(std::move(matrix)), _rows(size.rows), _cols(size.cols) {
+        accounting::constructed();
+        accounting::allocated(_matrix.size() * sizeof(double));
+    }
+
+    /**
+     * Copies the entries into this matrix's buffer (its resource is kept), which only grows when it is too small.
+     */
+    Matrix &Matrix::operator=(const Matrix &other) {
+        if (this == &other) {
+            return *this;
+        }
+        accounting::copied();
+        if (other._matrix.size() > _matrix.capacity()) {
+            accounting::allocated(other._matrix.size() * sizeof(double));
+        }
+        _matrix = other._matrix;
+        _rows = other._rows;
+        _cols = other._cols;
+        _sum = other._sum;
+        return *this;
+    }
 
     /**
-     * Move constructor for rvalue vectors.
+     * Takes the buffer if both come from the same resource. Otherwise the entries are copied into this
+     * matrix's resource (std::pmr containers never move memory between resources), which counts as a copy.
      */
-    Matrix::Matrix(std::vector<double> &&matrix, int rows, int cols) // rvalue reference // move constructor
-            : _matrix(std::move(matrix)), _rows(rows), _cols(cols) { checkInput(_matrix.size(), _rows, _cols); }
+    Matrix &Matrix::operator=(Matrix &&other) {
+        if (this == &other) {
+            return *this;
+        }
+        if (_matrix.get_allocator() == other._matrix.get_allocator()) {
+            accounting::moved();
+        } else {
+            accounting::copied();
+            if (other._matrix.size() > _matrix.capacity()) {
+                accounting::allocated(other._matrix.size() * sizeof(double));
+            }
+        }
+        _matrix = std::move(other._matrix);
+        _rows = other._rows;
+        _cols = other._cols;
+        _sum = other._sum;
+        return *this;
+    }
 
     /**
      * @return new matrix with flipped signs
      */
-    Matrix Matrix::operator-() const {
+    Matrix Matrix::operator-() const &{
+        MATRIX_OPERATION("operator-()", _rows, _cols, entries(_rows, _cols), 2 * ENTRY * entries(_rows, _cols));
         Matrix matrix{*this};
         matrix.operator*=(-1);
         return matrix;
     }
 
+    /**
+     * @return this temporary with flipped signs (no new buffer)
+     */
+    Matrix Matrix::operator-() &&{
+        MATRIX_OPERATION("operator-()", _rows, _cols, entries(_rows, _cols), ENTRY * entries(_rows, _cols));
+        operator*=(-1);
+        return std::move(*this);
+    }
+
     /**
      *
      * @param other matrix of the same dimensions
      * @return new matrix with the calculated values
      */
-    Matrix Matrix::operator+(const Matrix &other) const {
+    Matrix Matrix::operator+(const Matrix &other) const &{
+        MATRIX_OPERATION("operator+", _rows, _cols, entries(_rows, _cols), 3 * ENTRY * entries(_rows, _cols));
         Matrix res_matrix{*this};
         res_matrix.operator+=(other);
         return res_matrix;
     }
 
+    /**
+     * @param other matrix of the same dimensions
+     * @return this temporary with the calculated values (no new buffer)
+     */
+    Matrix Matrix::operator+(const Matrix &other) &&{
+        MATRIX_OPERATION("operator+", _rows, _cols, entries(_rows, _cols), 3 * ENTRY * entries(_rows, _cols));
+        operator+=(other);
+        return std::move(*this);
+    }
+
     /**
      * @param other matrix of the same dimensions
      * @return new matrix with the calculated values
      */
-    Matrix Matrix::operator-(const Matrix &other) const {
+    Matrix Matrix::operator-(const Matrix &other) const &{
+        MATRIX_OPERATION("operator-", _rows, _cols, entries(_rows, _cols), 3 * ENTRY * entries(_rows, _cols));
         Matrix res_matrix{*this};
         res_matrix.operator-=(other);
         return res_matrix;
     }
 
+    /**
+     * @param other matrix of the same dimensions
+     * @return this temporary with the calculated values (no new buffer)
+     */
+    Matrix Matrix::operator-(const Matrix &other) &&{
+        MATRIX_OPERATION("operator-", _rows, _cols, entries(_rows, _cols), 3 * ENTRY * entries(_rows, _cols));
+        operator-=(other);
+        return std::move(*this);
+    }
+
     /**
      * @return copy of the matrix with same values
      */
-    Matrix Matrix::operator+() const {
+    Matrix Matrix::operator+() const &{
+        MATRIX_OPERATION("operator+()", _rows, _cols, 0, 2 * ENTRY * entries(_rows, _cols));
         return Matrix{*this};
     }
 
+    /**
+     * @return this temporary (moved, not copied)
+     */
+    Matrix Matrix::operator+() &&{
+        return std::move(*this);
+    }
+
     /**
      * @param other matrix of the same dimensions
      * @return reference of the matrix with the calculated values
      */
     Matrix &Matrix::operator+=(const Matrix &other) {
+        MATRIX_OPERATION("operator+=", _rows, _cols, entries(_rows, _cols), 3 * ENTRY * entries(_rows, _cols));
         checkDimensionsEq(_rows, _cols, other._rows, other._cols);
-        for (uint i = 0; i < _matrix.size(); ++i) {
-            _matrix[i] += other._matrix[i];
+        const counters::Scope scope{counters::ADD, static_cast<double>(_matrix.size()), 3 * ENTRY * _matrix.size()};
+        simd::kernels().add(_matrix.data(), other._matrix.data(), _matrix.size());
+        _sum.add(other._sum, false);
+        return *this;
+    }
+
+    /**
+     * @param other view of the same dimensions (it may look into this matrix)
+     * @return reference of the matrix with the calculated values
+     */
+    Matrix &Matrix::operator+=(const MatrixView &other) {
+        MATRIX_OPERATION("operator+=", _rows, _cols, entries(_rows, _cols), 3 * ENTRY * entries(_rows, _cols));
+        checkDimensionsEq(_rows, _cols, other.rows(), other.cols());
+        if (other.overlaps(_matrix.data(), _matrix.data() + _matrix.size())) { // would read entries already updated
+            return operator+=(other.toMatrix());
         }
+        const counters::Scope scope{counters::ADD, static_cast<double>(_matrix.size()), 3 * ENTRY * _matrix.size()};
+        other.addTo(_matrix.data());
+        _sum.reset();
         return *this;
     }
 
@@ -84,10 +261,29 @@ namespace zich {
      * @return reference of the matrix with the subtracted entries
      */
     Matrix &Matrix::operator-=(const Matrix &other) {
+        MATRIX_OPERATION("operator-=", _rows, _cols, entries(_rows, _cols), 3 * ENTRY * entries(_rows, _cols));
         checkDimensionsEq(_rows, _cols, other._rows, other._cols);
-        for (uint i = 0; i < _matrix.size(); ++i) {
-            _matrix[i] -= other._matrix[i];
+        const counters::Scope scope{counters::SUBTRACT, static_cast<double>(_matrix.size()),
+                                    3 * ENTRY * _matrix.size()};
+        simd::kernels().sub(_matrix.data(), other._matrix.data(), _matrix.size());
+        _sum.add(other._sum, true);
+        return *this;
+    }
+
+    /**
+     * @param other view of the same dimensions (it may look into this matrix)
+     * @return reference of the matrix with the subtracted entries
+     */
+    Matrix &Matrix::operator-=(const MatrixView &other) {
+        MATRIX_OPERATION("operator-=", _rows, _cols, entries(_rows, _cols), 3 * ENTRY * entries(_rows, _cols));
+        checkDimensionsEq(_rows, _cols, other.rows(), other.cols());
+        if (other.overlaps(_matrix.data(), _matrix.data() + _matrix.size())) {
+            return operator-=(other.toMatrix());
         }
+        const counters::Scope scope{counters::SUBTRACT, static_cast<double>(_matrix.size()),
+                                    3 * ENTRY * _matrix.size()};
+        other.subtractFrom(_matrix.data());
+        _sum.reset();
         return *this;
     }
 
@@ -96,8 +292,7 @@ namespace zich {
      * @return true if the sum of the entries is greater
      */
     bool Matrix::operator>(const Matrix &other) const {
-        checkDimensionsEq(_rows, _cols, other._rows, other._cols);
-        return (this->calculateSum() > other.calculateSum()); // helper function calculates the sums
+        return compareSums(other) == 1;
     }
 
     /**
@@ -105,7 +300,8 @@ namespace zich {
      * @return true if the sum of entries is greater or equal
      */
     bool Matrix::operator>=(const Matrix &other) const {
-        return (*this > other || *this == other);
+        const int order = compareSums(other);
+        return order == 1 || (order != -1 && *this == other); // equal matrices have equal sums
     }
 
     /**
@@ -113,8 +309,7 @@ namespace zich {
      * @return true if the sum of entries is smaller
      */
     bool Matrix::operator<(const Matrix &other) const {
-        checkDimensionsEq(_rows, _cols, other._rows, other._cols);
-        return (this->calculateSum() < other.calculateSum());
+        return compareSums(other) == -1;
     }
 
     /**
@@ -122,7 +317,8 @@ namespace zich {
      * @return true if the sum of entries is smaller or equal
      */
     bool Matrix::operator<=(const Matrix &other) const {
-        return (*this < other || *this == other);
+        const int order = compareSums(other);
+        return order == -1 || (order != 1 && *this == other);
     }
 
     /**
@@ -152,7 +348,10 @@ namespace zich {
      * @return matrix reference with incremented values
      */
     Matrix &Matrix::operator++() {
-        std::for_each(_matrix.begin(), _matrix.end(), [](double &val) { ++val; });
+        MATRIX_OPERATION("operator++()", _rows, _cols, entries(_rows, _cols), 2 * ENTRY * entries(_rows, _cols));
+        const counters::Scope scope{counters::SHIFT, static_cast<double>(_matrix.size()), 2 * ENTRY * _matrix.size()};
+        simd::kernels().shift(_matrix.data(), 1, _matrix.size());
+        _sum.shift(1, _matrix.size());
         return *this;
     }
 
@@ -161,7 +360,10 @@ namespace zich {
      * @return matrix reference with decremented entries
      */
     Matrix &Matrix::operator--() {
-        std::for_each(_matrix.begin(), _matrix.end(), [](double &val) { --val; });
+        MATRIX_OPERATION("operator--()", _rows, _cols, entries(_rows, _cols), 2 * ENTRY * entries(_rows, _cols));
+        const counters::Scope scope{counters::SHIFT, static_cast<double>(_matrix.size()), 2 * ENTRY * _matrix.size()};
+        simd::kernels().shift(_matrix.data(), -1, _matrix.size());
+        _sum.shift(-1, _matrix.size());
         return *this;
     }
 
@@ -170,6 +372,7 @@ namespace zich {
      * @return new matrix with old values (actual matrix is incremented)
      */
     Matrix Matrix::operator++(int) {
+        MATRIX_OPERATION("operator++(int)", _rows, _cols, entries(_rows, _cols), 4 * ENTRY * entries(_rows, _cols));
         Matrix mat_copy{*this};
         ++(*this);
         return mat_copy;
@@ -180,6 +383,7 @@ namespace zich {
      * @return new matrix with old values (actual matrix is decremented)
      */
     Matrix Matrix::operator--(int) {
+        MATRIX_OPERATION("operator--(int)", _rows, _cols, entries(_rows, _cols), 4 * ENTRY * entries(_rows, _cols));
         Matrix mat_copy{*this};
         --(*this);
         return mat_copy;
@@ -190,13 +394,13 @@ namespace zich {
      * @return matrix reference with the multiplied entries
      */
     /*
-     * https://www.cprogramming.com/c++11/c++11-lambda-closures.html
-     * Explains lambda and specifically captures.
-     * In the lambda below, only scalar is captured by making a copy.
-     * The lambda in for_each defines what function to apply to each element in _matrix.
+     * The elementwise operators use the SIMD kernels from Simd.hpp (chosen once for the host CPU).
      */
     Matrix &Matrix::operator*=(double scalar) {
-        std::for_each(_matrix.begin(), _matrix.end(), [&scalar](double &val) { val *= scalar; });
+        MATRIX_OPERATION("operator*=(double)", _rows, _cols, entries(_rows, _cols), 2 * ENTRY * entries(_rows, _cols));
+        const counters::Scope scope{counters::SCALE, static_cast<double>(_matrix.size()), 2 * ENTRY * _matrix.size()};
+        simd::kernels().scale(_matrix.data(), scalar, _matrix.size());
+        _sum.scale(scalar);
         return *this;
     }
 
@@ -204,56 +408,167 @@ namespace zich {
      * @param scalar double
      * @return new matrix with the multiplied entries
      */
-    Matrix Matrix::operator*(double scalar) const {
+    Matrix Matrix::operator*(double scalar) const &{
+        MATRIX_OPERATION("operator*(double)", _rows, _cols, entries(_rows, _cols), 2 * ENTRY * entries(_rows, _cols));
         Matrix res_mat{*this};
         res_mat.operator*=(scalar);
         return res_mat;
     }
 
+    /**
+     * @param scalar double
+     * @return this temporary with the multiplied entries (no new buffer)
+     */
+    Matrix Matrix::operator*(double scalar) &&{
+        MATRIX_OPERATION("operator*(double)", _rows, _cols, entries(_rows, _cols), 2 * ENTRY * entries(_rows, _cols));
+        operator*=(scalar);
+        return std::move(*this);
+    }
+
     /**
      * @param other matrix with valid dimensions for matrix multiplication (_cols = other._rows)
      * @return new matrix with dimensions (_rows x other._cols) and matrix multiplication values
      */
-    Matrix Matrix::operator*(const Matrix &other) const {
+    Matrix Matrix::operator*(const Matrix &other) const &{
+        MATRIX_OPERATION("operator*", _rows, other._cols, productFlops(_rows, _cols, other._cols),
+                         productBytes(_rows, _cols, other._cols));
         Matrix mat_copy{*this};
         mat_copy.operator*=(other);
         return mat_copy;
     }
 
-    /*
-     * 0 1 2    0 1 2
-     * 3 4 5    3 4 5
-     *          6 7 8
+    /**
+     * The left operand is a temporary, so it is not copied before multiplying.
+     * @param other matrix with valid dimensions for matrix multiplication (_cols = other._rows)
+     * @return this temporary holding the product
      */
+    Matrix Matrix::operator*(const Matrix &other) &&{
+        MATRIX_OPERATION("operator*", _rows, other._cols, productFlops(_rows, _cols, other._cols),
+                         productBytes(_rows, _cols, other._cols));
+        operator*=(other);
+        return std::move(*this);
+    }
+
     /**
+     * Uses the packed, cache-blocked kernel from Gemm.hpp, or an O(n^2) path when a side is zero or diagonal.
+     * Each entry is still summed in the same order as the textbook loop, so results do not change,
+     * unless the Strassen-Winograd mode was turned on with strassen::configure (see Strassen.hpp).
      * @param other matrix with valid dimensions for matrix multiplication (_cols = other._rows)
      * @return matrix reference with updated dimensions (_rows x other._cols) and matrix multiplication values
      */
     Matrix &Matrix::operator*=(const Matrix &other) {
-        checkDimensionsMul(_cols, other._rows);
-        vector<double> mat_mul; // init new result vector
-        uint shared_index = 0; // shared_index -> left mat col = right mat row
-        uint right_mat_step = static_cast<uint>(other._cols); // number of indices to skip to next row in column
-        uint right_mat_col = 0; // current column number of right matrix (for inner loop)
-        double curr_sum = 0; // sum of current entry
-        for (uint i = 0; i < _matrix.size(); i += static_cast<uint>(_cols)) { // loop left matrix, i->skips to next row
-            right_mat_col = 0; // start from first column in right matrix
-            for (uint j = 0; j < other._matrix.size(); ++j) { // loop right matrix (multiply the ith row by all columns)
-                curr_sum += (_matrix[shared_index + i] * // i = start of current row + shared_index = current column
-                             // shared_index * right_mat_step = skip to the row below in the current column (right_mat_col)
-                             other._matrix[right_mat_col + (shared_index * right_mat_step)]);
-                ++shared_index; // increment to next value in left mat row / right mat column
-                if (shared_index == _cols) { // _cols == other._rows (finished current entry)
-                    shared_index = 0;
-                    mat_mul.push_back(curr_sum); // insert sum of entry
-                    curr_sum = 0;
-                    ++right_mat_col;
-                }
+        return multiplyAssign(other, 0);
+    }
+
+    /**
+     * Strided views are read in place by the kernel (no copy of the block).
+     * @param other view with valid dimensions for matrix multiplication (_cols = other.rows())
+     * @return matrix reference with updated dimensions (_rows x other.cols())
+     */
+    Matrix &Matrix::operator*=(const MatrixView &other) {
+        return multiplyAssign(other, 0);
+    }
+
+    /**
+     * Matrix multiplication with a per-call thread cap (the global cap is set with ThreadPool::setMaxThreads).
+     * @param max_threads maximum number of threads for this product, 0 = global limit
+     * @return new matrix with dimensions (_rows x other._cols)
+     */
+    Matrix Matrix::multiply(const Matrix &other, unsigned max_threads) const {
+        MATRIX_OPERATION("multiply", _rows, other._cols, productFlops(_rows, _cols, other._cols),
+                         productBytes(_rows, _cols, other._cols));
+        Matrix mat_copy{*this};
+        mat_copy.multiplyAssign(other, max_threads);
+        return mat_copy;
+    }
+
+    /**
+     * Cache-oblivious recursive transpose (see Transpose.hpp).
+     * @return new matrix with dimensions (_cols x _rows)
+     */
+    Matrix Matrix::transpose() const {
+        MATRIX_OPERATION("transpose", _cols, _rows, 0, 2 * ENTRY * entries(_rows, _cols));
+        Matrix transposed{{_cols, _rows}, memory::current()};
+        transpose::copy(_matrix.data(), static_cast<size_t>(_cols), transposed._matrix.data(),
+                        static_cast<size_t>(_rows), static_cast<size_t>(_rows), static_cast<size_t>(_cols));
+        return transposed;
+    }
+
+    /**
+     * Transposes without a second buffer (rectangular matrices use one bit per entry to follow the cycles).
+     * @return matrix reference with dimensions (_cols x _rows)
+     */
+    Matrix &Matrix::transposeInPlace() {
+        MATRIX_OPERATION("transposeInPlace", _cols, _rows, 0, 2 * ENTRY * entries(_rows, _cols));
+        transpose::inPlace(_matrix.data(), static_cast<size_t>(_rows), static_cast<size_t>(_cols));
+        std::swap(_rows, _cols);
+        _sum.reorder();
+        return *this;
+    }
+
+    /**
+     * Detected on each call (a general matrix is ruled out after a few entries), so nothing goes stale.
+     * @return mask of structure::Flag values
+     */
+    unsigned Matrix::structure() const {
+        return structure::detect(*this);
+    }
+
+    bool Matrix::hasStructure(unsigned flags) const {
+        return structure::holds(*this, flags);
+    }
+
+    const Matrix &Matrix::expectStructure(unsigned flags) const {
+        if (!hasStructure(flags)) {
+            throw std::logic_error{"Matrix does not have the expected structure!"};
+        }
+        return *this;
+    }
+
+    // product buffer of operator*= kept by this thread (see multiplyAssign)
+    static thread_local memory::Buffer mat_mul{memory::heap(memory::HugePages::NONE)};
+
+    static void releaseProductScratch() {
+        memory::Buffer{mat_mul.get_allocator()}.swap(mat_mul);
+    }
+
+    /*
+     * The product cannot be written over an operand while the kernel still reads it,
+     * so it goes into a per-thread scratch buffer which then swaps with _matrix.
+     * The old buffer becomes the next scratch buffer, so chained products on one thread stop allocating.
+     * Buffers from another resource (a pool or an arena) cannot be swapped with the scratch buffer:
+     * the product goes into a new buffer from the same resource, which recycles the old one.
+     * At most MAX_SCRATCH_SIZE doubles are kept, and ThreadPool workers free theirs when they go idle.
+     */
+    Matrix &Matrix::multiplyAssign(const MatrixView &other, unsigned max_threads) {
+        checkDimensionsMul(_cols, other.rows());
+        const size_t size = static_cast<size_t>(_rows) * static_cast<size_t>(other.cols());
+        const double flops = productFlops(_rows, _cols, other.cols());
+        const double bytes = productBytes(_rows, _cols, other.cols());
+        MATRIX_OPERATION("operator*=", _rows, other.cols(), flops, bytes);
+        const counters::Scope scope{counters::MULTIPLY, flops, bytes};
+        static const bool registered = (ThreadPool::instance().releaseWhenIdle(releaseProductScratch), true);
+        static_cast<void>(registered);
+        if (_matrix.get_allocator() != mat_mul.get_allocator()) {
+            memory::Buffer product(size, _matrix.get_allocator());
+            accounting::allocated(size * sizeof(double));
+            zich::multiply(MatrixView{*this}, other, product.data(), max_threads);
+            _matrix.swap(product); // same resource, so the swap is O(1)
+        } else {
+            if (size > mat_mul.capacity()) {
+                accounting::allocated(size * sizeof(double));
+            }
+            mat_mul.resize(size);
+            // Strassen-Winograd (when turned on) or the blocked kernel, see zich::multiply in MatrixView.cpp
+            zich::multiply(MatrixView{*this}, other, mat_mul.data(), max_threads);
+            _matrix.swap(mat_mul); // swaps the contents (addresses) of the vectors, avoids copying (swap is O(1))
+            // vector must be of the same data type, size can differ
+            if (mat_mul.capacity() > MAX_SCRATCH_SIZE) { // do not pin huge buffers to the thread
+                releaseProductScratch();
             }
         }
-        _matrix.swap(mat_mul); // swaps the contents (addresses) of the vectors, avoids copying (swap is O(1))
-        // vector must be of the same data type, size can differ
-        _cols = other._cols;
+        _cols = other.cols();
+        _sum.reset();
         return *this;
     }
 
@@ -268,11 +583,64 @@ namespace zich {
      * @return new matrix with multiplied entries
      */
     Matrix operator*(double scalar, const Matrix &matrix) {
+        const double size = entries(matrix._rows, matrix._cols);
+        MATRIX_OPERATION("operator*(double)", matrix._rows, matrix._cols, size, 2 * ENTRY * size);
         Matrix res_matrix{matrix};
         res_matrix.operator*=(scalar);
         return res_matrix;
     }
 
+    /**
+     * friend function for scalar on left side and a temporary matrix
+     * @return the temporary with multiplied entries (no new buffer)
+     */
+    Matrix operator*(double scalar, Matrix &&matrix) {
+        const double size = entries(matrix._rows, matrix._cols);
+        MATRIX_OPERATION("operator*(double)", matrix._rows, matrix._cols, size, 2 * ENTRY * size);
+        matrix.operator*=(scalar);
+        return std::move(matrix);
+    }
+
+    /**
+     * Addition is commutative in IEEE arithmetic, so the sum is accumulated into the temporary on the right.
+     * @return the right temporary with the calculated values
+     */
+    Matrix operator+(const Matrix &left, Matrix &&right) {
+        const double size = entries(right._rows, right._cols);
+        MATRIX_OPERATION("operator+", right._rows, right._cols, size, 3 * ENTRY * size);
+        right.operator+=(left);
+        return std::move(right);
+    }
+
+    Matrix operator+(Matrix &&left, Matrix &&right) {
+        const double size = entries(right._rows, right._cols);
+        MATRIX_OPERATION("operator+", right._rows, right._cols, size, 3 * ENTRY * size);
+        left.operator+=(right);
+        return std::move(left);
+    }
+
+    /**
+     * Subtraction into the temporary on the right: right[i] = left[i] - right[i].
+     * @return the right temporary with the calculated values
+     */
+    Matrix operator-(const Matrix &left, Matrix &&right) {
+        const double size = entries(right._rows, right._cols);
+        MATRIX_OPERATION("operator-", right._rows, right._cols, size, 3 * ENTRY * size);
+        Matrix::checkDimensionsEq(left._rows, left._cols, right._rows, right._cols);
+        const counters::Scope scope{counters::SUBTRACT, static_cast<double>(right._matrix.size()),
+                                    3 * ENTRY * right._matrix.size()};
+        simd::kernels().rsub(right._matrix.data(), left._matrix.data(), right._matrix.size());
+        right._sum.subtractFrom(left._sum);
+        return std::move(right);
+    }
+
+    Matrix operator-(Matrix &&left, Matrix &&right) {
+        const double size = entries(right._rows, right._cols);
+        MATRIX_OPERATION("operator-", right._rows, right._cols, size, 3 * ENTRY * size);
+        left.operator-=(right);
+        return std::move(left);
+    }
+
     /*
      * https://2019.cppconf-piter.ru/en/2019/spb/talks/45r2fxppvo0iabreclznd/
      * https://www.codesynthesis.com/~boris/blog/2012/07/24/const-rvalue-references/#:~:text=Note%20the%20asymmetry%3A%20while%20a,const%20rvalue%20references%20pretty%20useless.
@@ -281,52 +649,52 @@ namespace zich {
      * Print matrix. Each row is in brackets and there is a newline in between rows.
      */
     std::ostream &operator<<(std::ostream &out, const Matrix &matrix) {
-        double curr_val = 0;
-        for (uint i = 0; i < matrix._rows; ++i) { // loop rows
-            out << "[";
-            uint start_index = i * static_cast<uint>(matrix._cols); // start index of the ith row
-            uint end_of_row_index = start_index + static_cast<uint>(matrix._cols); // end of the ith row index
-            for (uint j = start_index; j < end_of_row_index; ++j) { // loop row according to indices calculated above
-                // floating point signbit could be negative and print -0 (even though 0 == -0)
-                curr_val = matrix._matrix[j] == 0 ? 0 : matrix._matrix[j];
-                out << curr_val;
-                if (j < end_of_row_index - 1) { // space in between numbers (not including first and last values)
-                    out << " ";
-                }
-            }
-            out << "]";
-            if (i < (matrix._rows - 1)) { // avoid newline after last row
-                out << '\n';
-            }
-        }
+        return matrix.print(out, 1);
+    }
+
+    /**
+     * Same output as operator<<, with row blocks formatted in parallel.
+     * @param max_threads maximum number of formatting threads, 0 = global limit
+     */
+    std::ostream &Matrix::print(std::ostream &out, unsigned max_threads) const {
+        MATRIX_OPERATION("operator<<", _rows, _cols, 0, ENTRY * entries(_rows, _cols));
+        const counters::Scope scope{counters::WRITE, 0, ENTRY * _matrix.size()};
+        formatter::write(out, _matrix.data(), static_cast<size_t>(_rows), static_cast<size_t>(_cols), max_threads);
         return out;
     }
 
     /**
      * Parse user input into a matrix object.
      * Valid format example: [1 0 0], [0 1 0], [0 0 1]
+     * The matrix is left unchanged if the input is invalid (see parser::scan for the errors).
      * @param matrix reference of matrix to parse input into
      */
     std::istream &operator>>(std::istream &in, Matrix &matrix) {
-        string str_input;
-        getline(in, str_input);
-
-        vector<double> new_mat;
-        vector<string> input_rows;
-
-        Matrix::cinSplitRows(str_input, input_rows); // if no exception was thrown: rows are valid
-        int col_size = Matrix::cinColumnsCheck(input_rows); // if no exception was thrown: columns are valid
-        Matrix::cinInsertNumbers(new_mat, input_rows); // if passed functions above: ready for parsing into matrix
-        int row_size = static_cast<int>(input_rows.size());
+        MATRIX_OPERATION("operator>>");
+        counters::Scope scope{counters::READ, 0, 0};
+        thread_local string str_input; // keeps its capacity between calls
+        {
+            ZICH_TRACE("read line");
+            getline(in, str_input);
+        }
 
-        // check if parsing was successful
-        if (new_mat.empty() || new_mat.size() != row_size * col_size) {
-            throw std::runtime_error{"Error: Matrix size does not match dimensions after parsing!"};
+        memory::Buffer new_mat{matrix._matrix.get_allocator()};
+        parser::Shape shape{};
+        {
+            ZICH_TRACE("parse", 0, 0, 0, static_cast<double>(str_input.size()));
+            shape = parser::scan(str_input, [&new_mat](double value) {
+                if (new_mat.size() == new_mat.capacity()) { // grows
+                    accounting::allocated(std::max<size_t>(1, 2 * new_mat.size()) * sizeof(double));
+                }
+                new_mat.push_back(value);
+            });
         }
 
         matrix._matrix.swap(new_mat);
-        matrix._rows = row_size;
-        matrix._cols = col_size;
+        matrix._rows = shape.rows;
+        matrix._cols = shape.cols;
+        matrix._sum.reset();
+        scope.work(0, ENTRY * matrix._matrix.size());
 
         return in;
     }
@@ -335,78 +703,6 @@ namespace zich {
 // private class methods and helper functions
 // *******************************************
 
-    /**
-        * Split input string by rows and insert into a vector.
-        */
-    void Matrix::cinSplitRows(const string &str_input, vector<string> &input_rows) {
-        std::regex extract_rows{R"(\,\s)"};
-        // when sub-match index parameter is -1 -> performs splitting
-        std::sregex_token_iterator iter_start{str_input.begin(), str_input.end(), extract_rows, -1};
-        std::sregex_token_iterator iter_end;
-        while (iter_start != iter_end) {
-            input_rows.push_back(iter_start->str());
-            ++iter_start;
-        }
-        Matrix::cinRowsCheck(input_rows); // call helper function
-    }
-
-    /**
-     * Check that each row is in the valid format.
-     */
-    void Matrix::cinRowsCheck(vector<string> &input_rows) {
-        // these websites were useful for testing the regex: https://www.regextester.com/97722, https://regex101.com/
-        std::regex check_rows{R"(\[(\-?\d+(\.\d+)?)(\s\-?\d+(\.\d+)?)*\])"};
-        for (const string &row: input_rows) {
-            if (!std::regex_match(row, check_rows)) {
-                throw std::runtime_error{"Could not parse input!"};
-            }
-        }
-    }
-
-    /**
-     * Check that user input rows have the same number of columns.
-     * @return number of columns
-     */
-    int Matrix::cinColumnsCheck(vector<string> &input_rows) {
-        int prev_num_count = -1;
-        int num_count = 1; // num_count starts from 1 (one value does not have spaces in between)
-        for (const string &row: input_rows) {
-            for (const char &c: row) {
-                if (c == ' ') {
-                    ++num_count;
-                }
-            }
-            if (prev_num_count != -1 && num_count != prev_num_count) { // check from second iteration
-                throw std::runtime_error{"Invalid column dimensions!"};
-            }
-            prev_num_count = num_count;
-            num_count = 1;
-        }
-        return prev_num_count; // return number of columns to update the matrix
-    }
-
-    /**
-     * Split input rows by spaces and append to the matrix vector.
-     */
-    /*
-     * std::regex_token_iterator: https://en.cppreference.com/w/cpp/regex/regex_token_iterator
-     * "accesses the individual sub-matches of every match of a regular expression"
-     */
-    void Matrix::cinInsertNumbers(vector<double> &new_mat, vector<string> &input_rows) {
-        std::regex get_nums{R"(\s)"};
-        for (string &row: input_rows) {
-            // start iterator from +1 and end at -1 to ignore the brackets
-            // safe to assume since this helper function is called after the rows are split and input is validated
-            // iter_end is the end of sequence (default constructor)
-            std::sregex_token_iterator iter_start{row.begin() + 1, row.end() - 1, get_nums, -1};
-            std::sregex_token_iterator iter_end;
-            while (iter_start != iter_end) {
-                new_mat.push_back(std::stod(iter_start->str()));
-                ++iter_start;
-            }
-        }
-    }
-
     /**
      * Checks that the matrix has valid dimensions.
      * This is called in the constructors.
@@ -438,14 +734,38 @@ namespace zich {
 
     /**
      * Used in comparison functions.
+     * Compensated and chunked (see Reduce.hpp), so the result is accurate and the same on every CPU and thread count.
+     * It is computed once and cached until the entries change (see SumCache.hpp).
      * @return sum of matrix entries
      */
     double Matrix::calculateSum() const {
-        double mat_sum = 0;
-        for (const double &val: _matrix) {
-            mat_sum += val;
+        return _sum.exact(_matrix.data(), _matrix.size());
+    }
+
+    /**
+     * Decides from the cached bounds when they do not overlap, otherwise from the exact sums.
+     * @return -1, 0 or 1 if the sum is smaller, equal or greater, 2 if a sum is NaN
+     */
+    int Matrix::compareSums(const Matrix &other) const {
+        checkDimensionsEq(_rows, _cols, other._rows, other._cols);
+        double low = 0, high = 0, other_low = 0, other_high = 0;
+        if (_sum.bounds(_matrix.size(), low, high) && other._sum.bounds(other._matrix.size(), other_low, other_high)) {
+            if (high < other_low) {
+                return -1;
+            }
+            if (low > other_high) {
+                return 1;
+            }
+        }
+        const double sum = calculateSum();
+        const double other_sum = other.calculateSum();
+        if (sum < other_sum) {
+            return -1;
+        }
+        if (sum > other_sum) {
+            return 1;
         }
-        return mat_sum;
+        return sum == other_sum ? 0 : 2;
     }
 
 }
\ No newline at end of file
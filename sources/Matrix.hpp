@@ -1,9 +1,14 @@
 #ifndef CPP_EX3_MATRIX_HPP
 #define CPP_EX3_MATRIX_HPP
 
+#include <cstddef>
 #include <iostream>
+#include <memory_resource>
 #include <vector>
 #include <string>
+#include "BasicMatrix.hpp"
+#include "Memory.hpp"
+#include "SumCache.hpp"
 
 /*
  * Why the {}-initializer (list initialization) syntax is preferred:
@@ -14,11 +19,30 @@
  */
 namespace zich {
 
-    class Matrix {
+    namespace expr {
+        template<class E>
+        struct Expr; // lazy expressions, see MatrixExpr.hpp
+    }
+
+    class MatrixView; // non-owning blocks and slices, see MatrixView.hpp
+
+    class MappedMatrix; // see MatrixFile.hpp
+
+    class SparseMatrix; // see SparseMatrix.hpp
+
+    template<std::size_t R, std::size_t C>
+    class FixedMatrix; // see FixedMatrix.hpp
+
+    /*
+     * The double matrix (zich::Matrix). Other element types use the generic template in BasicMatrix.hpp.
+     */
+    template<>
+    class BasicMatrix<double> {
     private:
-        std::vector<double> _matrix;
+        memory::Buffer _matrix; // from memory::current() when the matrix is created, see Memory.hpp
         int _rows;
         int _cols;
+        SumCache _sum; // for the comparison operators, updated by the elementwise operators
 
         static void checkInput(unsigned int mat_size, int rows, int cols);
 
@@ -28,34 +52,101 @@ namespace zich {
 
         double calculateSum() const;
 
-        static void cinSplitRows(const std::string &str_input, std::vector<std::string> &input_rows);
+        int compareSums(const Matrix &other) const;
+
+        Matrix &multiplyAssign(const MatrixView &other, unsigned max_threads);
 
-        static void cinRowsCheck(std::vector<std::string> &input_rows);
+        struct Size {
+            int rows;
+            int cols;
+        };
 
-        static int cinColumnsCheck(std::vector<std::string> &input_rows);
+        // zero matrix, filled in place by the functions below that build new matrices
+        BasicMatrix(Size size, std::pmr::memory_resource *resource);
 
-        static void cinInsertNumbers(std::vector<double> &new_mat, std::vector<std::string> &input_rows);
+        // takes a buffer filled by one of the functions below (no copy)
+        BasicMatrix(memory::Buffer &&matrix, Size size);
 
     public:
+        typedef double value_type;
 
         // https://www.reddit.com/r/cpp_questions/comments/swaxw2/passing_a_vector_to_constructor/
         // https://stackoverflow.com/questions/46513507/c-copy-constructor-vs-move-constructor-for-stdvector
-        Matrix(const std::vector<double> &matrix, int rows, int cols); // constructor
+        BasicMatrix(const std::vector<double> &matrix, int rows, int cols); // constructor
+
+        /**
+         * Rvalue constructor. It copies the values like the lvalue constructor: the memory of a std::vector
+         * cannot be handed to the pmr buffer of a matrix (which comes from memory::current()).
+         */
+        BasicMatrix(std::vector<double> &&matrix, int rows, int cols);
+
+        // the copy takes its buffer from memory::current(), like every new matrix
+        BasicMatrix(const Matrix &other);
+
+        /**
+         * Copy with its buffer from the given resource (for example to keep a result of a ScopedArena).
+         */
+        BasicMatrix(const Matrix &other, std::pmr::memory_resource *resource);
+
+        // moves keep the buffer and its resource, assignments keep the target's resource
+        BasicMatrix(Matrix &&other) noexcept;
+
+        Matrix &operator=(const Matrix &other);
+
+        Matrix &operator=(Matrix &&other);
+
+        ~BasicMatrix() = default;
+
+        // evaluates a lazy expression in one pass (defined in MatrixExpr.hpp)
+        template<class E>
+        explicit BasicMatrix(const expr::Expr<E> &expression);
 
-        Matrix(std::vector<double> &&matrix, int rows, int cols); // rvalue constructor
+        template<class E>
+        Matrix &operator=(const expr::Expr<E> &expression);
 
-        Matrix operator-() const;
+        template<class E>
+        Matrix &operator+=(const expr::Expr<E> &expression);
 
-        Matrix operator+(const Matrix &other) const;
+        template<class E>
+        Matrix &operator-=(const expr::Expr<E> &expression);
 
-        Matrix operator-(const Matrix &other) const;
+        int rows() const { return _rows; }
 
-        Matrix operator+() const;
+        int cols() const { return _cols; }
+
+        const double *data() const { return _matrix.data(); }
+
+        std::pmr::memory_resource *resource() const { return _matrix.get_allocator().resource(); }
+
+        /*
+         * The && overloads run when the left operand is a temporary: they update it in place and move it out,
+         * so a chain like (a + b - c) * 2.0 only allocates the first temporary.
+         * https://en.cppreference.com/w/cpp/language/member_functions#ref-qualified_member_functions
+         */
+        Matrix operator-() const &;
+
+        Matrix operator-() &&;
+
+        Matrix operator+(const Matrix &other) const &;
+
+        Matrix operator+(const Matrix &other) &&;
+
+        Matrix operator-(const Matrix &other) const &;
+
+        Matrix operator-(const Matrix &other) &&;
+
+        Matrix operator+() const &;
+
+        Matrix operator+() &&;
 
         Matrix &operator+=(const Matrix &other);
 
+        Matrix &operator+=(const MatrixView &other);
+
         Matrix &operator-=(const Matrix &other);
 
+        Matrix &operator-=(const MatrixView &other);
+
         bool operator>(const Matrix &other) const;
 
         bool operator>=(const Matrix &other) const;
@@ -85,16 +176,81 @@ namespace zich {
         // https://abseil.io/tips/109
         Matrix &operator*=(double scalar);
 
-        Matrix operator*(double scalar) const;
+        Matrix operator*(double scalar) const &;
+
+        Matrix operator*(double scalar) &&;
 
-        Matrix operator*(const Matrix &other) const;
+        Matrix operator*(const Matrix &other) const &;
+
+        Matrix operator*(const Matrix &other) &&;
 
         Matrix &operator*=(const Matrix &other);
 
+        Matrix &operator*=(const MatrixView &other);
+
+        Matrix multiply(const Matrix &other, unsigned max_threads) const;
+
+        std::ostream &print(std::ostream &out, unsigned max_threads) const;
+
+        Matrix transpose() const;
+
+        /**
+         * @return mask of the structure::Flag values (zero, diagonal, identity, ...) that hold, see Structure.hpp
+         */
+        unsigned structure() const;
+
+        /**
+         * @return true if every flag in the mask holds (only those flags are checked)
+         */
+        bool hasStructure(unsigned flags) const;
+
+        /**
+         * @return this matrix
+         * @throws std::logic_error if a flag in the mask does not hold
+         */
+        const Matrix &expectStructure(unsigned flags) const;
+
+        Matrix &transposeInPlace();
+
         // friend functions
 
+        friend class MatrixView; // toMatrix
+
+        // conversions and products that write their result straight into a new matrix
+
+        friend class MappedMatrix;
+
+        friend class SparseMatrix;
+
+        template<std::size_t R, std::size_t C>
+        friend class FixedMatrix;
+
+        friend Matrix readBinary(std::istream &in);
+
+        friend Matrix operator*(const SparseMatrix &sparse, const MatrixView &dense);
+
+        friend Matrix operator*(const MatrixView &dense, const SparseMatrix &sparse);
+
+        friend Matrix operator+(const MatrixView &left, const MatrixView &right);
+
+        friend Matrix operator-(const MatrixView &left, const MatrixView &right);
+
+        friend Matrix operator*(const MatrixView &left, const MatrixView &right);
+
         friend Matrix operator*(double scalar, const Matrix &matrix);
 
+        friend Matrix operator*(double scalar, Matrix &&matrix);
+
+        // right operand is a temporary: its buffer holds the result
+
+        friend Matrix operator+(const Matrix &left, Matrix &&right);
+
+        friend Matrix operator+(Matrix &&left, Matrix &&right);
+
+        friend Matrix operator-(const Matrix &left, Matrix &&right);
+
+        friend Matrix operator-(Matrix &&left, Matrix &&right);
+
         friend std::ostream &operator<<(std::ostream &out, const Matrix &matrix);
 
         friend std::istream &operator>>(std::istream &in, Matrix &matrix);
@@ -0,0 +1,229 @@
+#ifndef CPP_EX3_MATRIXEXPR_HPP
+#define CPP_EX3_MATRIXEXPR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include "Accounting.hpp"
+#include "Matrix.hpp"
+#include "ThreadPool.hpp"
+
+/*
+ * Expression templates for elementwise arithmetic.
+ * https://en.wikipedia.org/wiki/Expression_templates
+ *
+ * zich::lazy(a) + b - c * 2.0 builds a tree of small nodes instead of temporaries.
+ * Nothing is computed until the tree is assigned to a Matrix, which then evaluates every entry in one pass:
+ *     Matrix res{zich::lazy(a) + b - c * 2.0};
+ *     res = zich::lazy(res) * 0.5;
+ * Each entry goes through the same operations in the same order as the eager operators, so results are identical.
+ * Nodes keep pointers to the matrices they read, so an expression must not outlive its operands.
+ */
+namespace zich {
+
+    namespace expr {
+
+        /**
+         * CRTP base of every node: E provides rows(), cols() and value(i) for the row-major index i.
+         */
+        template<class E>
+        struct Expr {
+            const E &self() const { return static_cast<const E &>(*this); }
+        };
+
+        /**
+         * Leaf node reading the entries of a Matrix.
+         */
+        class Leaf : public Expr<Leaf> {
+        private:
+            const double *_data;
+            int _rows;
+            int _cols;
+
+        public:
+            explicit Leaf(const Matrix &matrix) : _data(matrix.data()), _rows(matrix.rows()), _cols(matrix.cols()) {}
+
+            int rows() const { return _rows; }
+
+            int cols() const { return _cols; }
+
+            double value(std::size_t i) const { return _data[i]; }
+        };
+
+        struct Plus {
+            static double apply(double left, double right) { return left + right; }
+        };
+
+        struct Minus {
+            static double apply(double left, double right) { return left - right; }
+        };
+
+        /**
+         * Elementwise binary node (matrix + matrix, matrix - matrix). Dimensions are checked when the node is built.
+         */
+        template<class L, class R, class Op>
+        class Binary : public Expr<Binary<L, R, Op>> {
+        private:
+            L _left;
+            R _right;
+
+        public:
+            Binary(const L &left, const R &right) : _left(left), _right(right) {
+                if (left.rows() != right.rows() || left.cols() != right.cols()) {
+                    throw std::invalid_argument{"Invalid dimensions for matrix addition or subtraction!"};
+                }
+            }
+
+            int rows() const { return _left.rows(); }
+
+            int cols() const { return _left.cols(); }
+
+            double value(std::size_t i) const { return Op::apply(_left.value(i), _right.value(i)); }
+        };
+
+        /**
+         * Multiplies every entry of the operand by a scalar.
+         */
+        template<class E>
+        class Scaled : public Expr<Scaled<E>> {
+        private:
+            E _operand;
+            double _scalar;
+
+        public:
+            Scaled(const E &operand, double scalar) : _operand(operand), _scalar(scalar) {}
+
+            int rows() const { return _operand.rows(); }
+
+            int cols() const { return _operand.cols(); }
+
+            double value(std::size_t i) const { return _operand.value(i) * _scalar; }
+        };
+
+        // entries per parallel chunk when evaluating very large expressions
+        constexpr std::size_t EVAL_CHUNK = std::size_t{1} << 16;
+
+        /**
+         * Evaluates the expression into dst in one fused pass (split across the thread pool when large).
+         */
+        template<class E>
+        void evaluate(const Expr<E> &expression, double *dst, std::size_t size) {
+            const E &node = expression.self();
+            if (size <= EVAL_CHUNK) {
+                for (std::size_t i = 0; i < size; ++i) {
+                    dst[i] = node.value(i);
+                }
+                return;
+            }
+            ThreadPool::instance().parallelFor((size + EVAL_CHUNK - 1) / EVAL_CHUNK, [&node, dst, size](std::size_t chunk) {
+                const std::size_t end = std::min(size, (chunk + 1) * EVAL_CHUNK);
+                for (std::size_t i = chunk * EVAL_CHUNK; i < end; ++i) {
+                    dst[i] = node.value(i);
+                }
+            });
+        }
+
+        template<class L, class R>
+        Binary<L, R, Plus> operator+(const Expr<L> &left, const Expr<R> &right) {
+            return Binary<L, R, Plus>{left.self(), right.self()};
+        }
+
+        template<class L>
+        Binary<L, Leaf, Plus> operator+(const Expr<L> &left, const Matrix &right) {
+            return Binary<L, Leaf, Plus>{left.self(), Leaf{right}};
+        }
+
+        template<class R>
+        Binary<Leaf, R, Plus> operator+(const Matrix &left, const Expr<R> &right) {
+            return Binary<Leaf, R, Plus>{Leaf{left}, right.self()};
+        }
+
+        template<class L, class R>
+        Binary<L, R, Minus> operator-(const Expr<L> &left, const Expr<R> &right) {
+            return Binary<L, R, Minus>{left.self(), right.self()};
+        }
+
+        template<class L>
+        Binary<L, Leaf, Minus> operator-(const Expr<L> &left, const Matrix &right) {
+            return Binary<L, Leaf, Minus>{left.self(), Leaf{right}};
+        }
+
+        template<class R>
+        Binary<Leaf, R, Minus> operator-(const Matrix &left, const Expr<R> &right) {
+            return Binary<Leaf, R, Minus>{Leaf{left}, right.self()};
+        }
+
+        template<class E>
+        Scaled<E> operator*(const Expr<E> &operand, double scalar) {
+            return Scaled<E>{operand.self(), scalar};
+        }
+
+        template<class E>
+        Scaled<E> operator*(double scalar, const Expr<E> &operand) {
+            return Scaled<E>{operand.self(), scalar};
+        }
+
+        template<class E>
+        Scaled<E> operator-(const Expr<E> &operand) {
+            return Scaled<E>{operand.self(), -1};
+        }
+
+        template<class E>
+        const E &operator+(const Expr<E> &operand) {
+            return operand.self();
+        }
+
+    }
+
+    /**
+     * Entry point of the lazy API: wraps a matrix so the following operators build an expression.
+     */
+    inline expr::Leaf lazy(const Matrix &matrix) {
+        return expr::Leaf{matrix};
+    }
+
+// *************************************************
+// Matrix members that consume expressions (Matrix.hpp)
+// *************************************************
+
+    template<class E>
+    Matrix::BasicMatrix(const expr::Expr<E> &expression)
+            : _matrix(static_cast<std::size_t>(expression.self().rows()) *
+                      static_cast<std::size_t>(expression.self().cols()), memory::current()),
+              _rows(expression.self().rows()), _cols(expression.self().cols()) {
+        accounting::constructed();
+        accounting::allocated(_matrix.size() * sizeof(double));
+        expr::evaluate(expression, _matrix.data(), _matrix.size());
+    }
+
+    /*
+     * Evaluating in place is safe even if the expression reads this matrix:
+     * entry i only depends on entry i of every operand.
+     */
+    template<class E>
+    Matrix &Matrix::operator=(const expr::Expr<E> &expression) {
+        const std::size_t size = static_cast<std::size_t>(expression.self().rows()) *
+                                 static_cast<std::size_t>(expression.self().cols());
+        if (size > _matrix.capacity()) {
+            accounting::allocated(size * sizeof(double));
+        }
+        _matrix.resize(size);
+        _rows = expression.self().rows();
+        _cols = expression.self().cols();
+        expr::evaluate(expression, _matrix.data(), _matrix.size());
+        _sum.reset();
+        return *this;
+    }
+
+    template<class E>
+    Matrix &Matrix::operator+=(const expr::Expr<E> &expression) {
+        return *this = expr::Binary<expr::Leaf, E, expr::Plus>{expr::Leaf{*this}, expression.self()};
+    }
+
+    template<class E>
+    Matrix &Matrix::operator-=(const expr::Expr<E> &expression) {
+        return *this = expr::Binary<expr::Leaf, E, expr::Minus>{expr::Leaf{*this}, expression.self()};
+    }
+
+}
+#endif //CPP_EX3_MATRIXEXPR_HPP
@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "MatrixFile.hpp"
+#include "Formatter.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ZICH_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using std::size_t;
+using std::string;
+using std::uint32_t;
+using std::uint64_t;
+
+namespace zich {
+
+    namespace {
+
+        void swapHeader(binary::Header &header) {
+            header.version = __builtin_bswap32(header.version);
+            header.endian = __builtin_bswap32(header.endian);
+            header.dtype = __builtin_bswap32(header.dtype);
+            header.alignment = __builtin_bswap32(header.alignment);
+            header.rows = __builtin_bswap64(header.rows);
+            header.cols = __builtin_bswap64(header.cols);
+            header.data_offset = __builtin_bswap64(header.data_offset);
+        }
+
+        /**
+         * Validates a header read from a file, converting it to the host byte order.
+         * @param swapped set to true if the file was written with the other byte order
+         * @return number of entries
+         */
+        size_t checkHeader(binary::Header &header, bool &swapped) {
+            if (std::memcmp(header.magic, binary::MAGIC, sizeof(binary::MAGIC)) != 0) {
+                throw std::runtime_error{"Invalid matrix file!"};
+            }
+            swapped = header.endian != binary::ENDIAN_MARKER;
+            if (swapped) {
+                swapHeader(header);
+                if (header.endian != binary::ENDIAN_MARKER) {
+                    throw std::runtime_error{"Invalid matrix file!"};
+                }
+            }
+            if (header.version == 0 || header.version > binary::VERSION) {
+                throw std::runtime_error{"Unsupported matrix file version!"};
+            }
+            if (header.dtype != binary::DTYPE_FLOAT64) {
+                throw std::runtime_error{"Unsupported matrix element type!"};
+            }
+            // the entries are read in place from a mapping, so they must be aligned for double;
+            // the offset must also fit a (signed) stream offset
+            const uint32_t alignment = header.alignment;
+            if (alignment < alignof(double) || (alignment & (alignment - 1)) != 0 ||
+                header.data_offset < sizeof(binary::Header) || header.data_offset % alignment != 0 ||
+                header.data_offset > static_cast<uint64_t>(INT64_MAX)) {
+                throw std::runtime_error{"Invalid matrix file!"};
+            }
+            // same limits as the Matrix constructors
+            if (header.rows < 1 || header.cols < 1 || header.rows > INT_MAX || header.cols > INT_MAX ||
+                header.rows * header.cols > INT_MAX) {
+                throw std::runtime_error{"Invalid matrix size!"};
+            }
+            return static_cast<size_t>(header.rows * header.cols);
+        }
+
+        // entries read at a time from streams that cannot tell their size (1 MiB)
+        constexpr size_t READ_CHUNK = size_t{1} << 17;
+
+        /**
+         * @return bytes left in the stream, or -1 if it cannot seek (a pipe, a socket)
+         */
+        std::streamoff remaining(std::istream &in) {
+            const std::streampos here = in.tellg();
+            if (here == std::streampos(-1)) {
+                in.clear();
+                return -1;
+            }
+            in.seekg(0, std::ios::end);
+            const std::streampos end = in.tellg();
+            in.clear();
+            in.seekg(here);
+            return end == std::streampos(-1) ? -1 : end - here;
+        }
+
+    }
+
+    void writeBinary(std::ostream &out, const Matrix &matrix) {
+        binary::Header header{};
+        std::memcpy(header.magic, binary::MAGIC, sizeof(binary::MAGIC));
+        header.version = binary::VERSION;
+        header.endian = binary::ENDIAN_MARKER;
+        header.dtype = binary::DTYPE_FLOAT64;
+        header.alignment = binary::DATA_ALIGNMENT;
+        header.rows = static_cast<uint64_t>(matrix.rows());
+        header.cols = static_cast<uint64_t>(matrix.cols());
+        header.data_offset = sizeof(binary::Header); // the header is exactly one alignment unit
+        const size_t size = static_cast<size_t>(matrix.rows()) * static_cast<size_t>(matrix.cols());
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char *>(matrix.data()), static_cast<std::streamsize>(size * sizeof(double)));
+        if (!out) {
+            throw std::runtime_error{"Could not write matrix file!"};
+        }
+    }
+
+    void writeBinary(const string &path, const Matrix &matrix) {
+        std::ofstream file{path, std::ios::binary | std::ios::trunc};
+        if (!file) {
+            throw std::runtime_error{"Could not open file!"};
+        }
+        writeBinary(file, matrix);
+        file.close();
+        if (!file) {
+            throw std::runtime_error{"Could not write matrix file!"};
+        }
+    }
+
+    Matrix readBinary(std::istream &in) {
+        binary::Header header{};
+        if (!in.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+            throw std::runtime_error{"Invalid matrix file!"};
+        }
+        bool swapped = false;
+        const size_t size = checkHeader(header, swapped);
+        const auto skip = static_cast<std::streamsize>(header.data_offset - sizeof(header));
+        if (in.ignore(skip).gcount() != skip) {
+            throw std::runtime_error{"Matrix file is truncated!"};
+        }
+        /*
+         * The sizes in the header are not trusted with an allocation: they are checked against the bytes left
+         * when the stream can seek, otherwise the values are read in chunks, so a truncated or forged header
+         * fails after allocating about as much as the stream really holds.
+         */
+        const std::streamoff available = remaining(in);
+        if (available >= 0 && static_cast<uint64_t>(available) < size * sizeof(double)) {
+            throw std::runtime_error{"Matrix file is truncated!"};
+        }
+        memory::Buffer values{memory::current()};
+        if (available >= 0) {
+            values.reserve(size);
+        }
+        while (values.size() < size) {
+            const size_t done = values.size();
+            const size_t chunk = std::min(READ_CHUNK, size - done);
+            values.resize(done + chunk);
+            const auto bytes = static_cast<std::streamsize>(chunk * sizeof(double));
+            if (!in.read(reinterpret_cast<char *>(values.data() + done), bytes)) {
+                throw std::runtime_error{"Matrix file is truncated!"};
+            }
+        }
+        if (swapped) {
+            for (double &value: values) {
+                uint64_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                bits = __builtin_bswap64(bits);
+                std::memcpy(&value, &bits, sizeof(bits));
+            }
+        }
+        return Matrix{std::move(values), {static_cast<int>(header.rows), static_cast<int>(header.cols)}};
+    }
+
+    Matrix readBinary(const string &path) {
+        std::ifstream file{path, std::ios::binary};
+        if (!file) {
+            throw std::runtime_error{"Could not open file!"};
+        }
+        return readBinary(file);
+    }
+
+// *******************************************
+// MappedMatrix
+// *******************************************
+
+#ifdef ZICH_HAS_MMAP
+
+    MappedMatrix::MappedMatrix(const string &path) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error{"Could not open file!"};
+        }
+        struct stat file_stat{};
+        if (::fstat(fd, &file_stat) != 0 || static_cast<size_t>(file_stat.st_size) < sizeof(binary::Header)) {
+            ::close(fd);
+            throw std::runtime_error{"Invalid matrix file!"};
+        }
+        _mapping_size = static_cast<size_t>(file_stat.st_size);
+        void *mapping = ::mmap(nullptr, _mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // the mapping keeps the file alive
+        if (mapping == MAP_FAILED) {
+            throw std::runtime_error{"Could not map matrix file!"};
+        }
+        _mapping = mapping;
+        try {
+            binary::Header header{};
+            std::memcpy(&header, _mapping, sizeof(header));
+            bool swapped = false;
+            const size_t size = checkHeader(header, swapped);
+            if (swapped) {
+                throw std::runtime_error{"Matrix file has the wrong byte order for mapping!"};
+            }
+            if (header.data_offset > _mapping_size ||
+                (_mapping_size - header.data_offset) / sizeof(double) < size) {
+                throw std::runtime_error{"Matrix file is truncated!"};
+            }
+            _data = reinterpret_cast<const double *>(static_cast<const char *>(_mapping) + header.data_offset);
+            _rows = static_cast<int>(header.rows);
+            _cols = static_cast<int>(header.cols);
+        } catch (...) {
+            unmap();
+            throw;
+        }
+    }
+
+    void MappedMatrix::unmap() {
+        if (_mapping != nullptr) {
+            ::munmap(_mapping, _mapping_size);
+        }
+        _mapping = nullptr;
+        _mapping_size = 0;
+        _data = nullptr;
+        _rows = 0;
+        _cols = 0;
+    }
+
+#else
+
+    MappedMatrix::MappedMatrix(const string & /*path*/) {
+        throw std::runtime_error{"Memory mapped files are not supported on this platform!"};
+    }
+
+    void MappedMatrix::unmap() {}
+
+#endif
+
+    MappedMatrix::MappedMatrix(MappedMatrix &&other) noexcept
+            : _mapping{std::exchange(other._mapping, nullptr)}, _mapping_size{std::exchange(other._mapping_size, 0)},
+              _data{std::exchange(other._data, nullptr)}, _rows{std::exchange(other._rows, 0)},
+              _cols{std::exchange(other._cols, 0)} {}
+
+    MappedMatrix &MappedMatrix::operator=(MappedMatrix &&other) noexcept {
+        if (this != &other) {
+            unmap();
+            _mapping = std::exchange(other._mapping, nullptr);
+            _mapping_size = std::exchange(other._mapping_size, 0);
+            _data = std::exchange(other._data, nullptr);
+            _rows = std::exchange(other._rows, 0);
+            _cols = std::exchange(other._cols, 0);
+        }
+        return *this;
+    }
+
+    MappedMatrix::~MappedMatrix() {
+        unmap();
+    }
+
+    MatrixView MappedMatrix::view() const {
+        return MatrixView{_data, _rows, _cols, static_cast<size_t>(_cols)};
+    }
+
+    Matrix MappedMatrix::toMatrix() const {
+        Matrix matrix{{_rows, _cols}, memory::current()};
+        std::copy(_data, _data + matrix._matrix.size(), matrix._matrix.data());
+        return matrix;
+    }
+
+    std::ostream &operator<<(std::ostream &out, const MappedMatrix &matrix) {
+        formatter::write(out, matrix._data, static_cast<size_t>(matrix._rows), static_cast<size_t>(matrix._cols));
+        return out;
+    }
+
+}
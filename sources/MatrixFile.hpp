@@ -0,0 +1,124 @@
+#ifndef CPP_EX3_MATRIXFILE_HPP
+#define CPP_EX3_MATRIXFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include "Matrix.hpp"
+#include "MatrixView.hpp"
+
+/*
+ * Binary matrix files: a 64 byte header followed by the raw row-major entries.
+ *
+ *   offset  size  field
+ *        0     8  magic "ZICHMAT\0"
+ *        8     4  format version (1)
+ *       12     4  endianness marker 0x01020304, written in the writer's byte order
+ *       16     4  element type (1 = IEEE-754 double)
+ *       20     4  data alignment in bytes (power of two, at least 8)
+ *       24     8  rows
+ *       32     8  cols
+ *       40     8  data offset from the start of the file (multiple of the alignment)
+ *       48    16  reserved, zero
+ *
+ * Header fields and entries use the writer's byte order. Readers byte-swap when the marker is reversed.
+ * Data starts 64 byte aligned, so a file mapped with mmap can be read in place by the SIMD kernels:
+ * https://man7.org/linux/man-pages/man2/mmap.2.html
+ */
+namespace zich {
+
+    namespace binary {
+
+        constexpr char MAGIC[8] = {'Z', 'I', 'C', 'H', 'M', 'A', 'T', '\0'};
+        constexpr std::uint32_t VERSION = 1;
+        constexpr std::uint32_t ENDIAN_MARKER = 0x01020304;
+        constexpr std::uint32_t DTYPE_FLOAT64 = 1;
+        constexpr std::uint32_t DATA_ALIGNMENT = 64;
+
+        struct Header {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t endian;
+            std::uint32_t dtype;
+            std::uint32_t alignment;
+            std::uint64_t rows;
+            std::uint64_t cols;
+            std::uint64_t data_offset;
+            std::uint8_t reserved[16];
+        };
+
+        static_assert(sizeof(Header) == 64, "the header layout is part of the file format");
+
+    }
+
+    /**
+     * Writes a matrix in the binary format.
+     * @throws std::runtime_error if the stream or file cannot be written
+     */
+    void writeBinary(std::ostream &out, const Matrix &matrix);
+
+    void writeBinary(const std::string &path, const Matrix &matrix);
+
+    /**
+     * Reads a matrix written by writeBinary: the entries are read straight into the matrix buffer, no parsing.
+     * @throws std::runtime_error if the header is invalid, unsupported or the data is truncated
+     */
+    Matrix readBinary(std::istream &in);
+
+    Matrix readBinary(const std::string &path);
+
+    /**
+     * Read-only matrix file mapped into memory. Opening it costs no parsing and no copy;
+     * pages are loaded by the OS on first access. The mapping lives as long as the object.
+     */
+    class MappedMatrix {
+
+    private:
+        void *_mapping{nullptr};
+        std::size_t _mapping_size{0};
+        const double *_data{nullptr};
+        int _rows{0};
+        int _cols{0};
+
+        void unmap();
+
+    public:
+        /**
+         * @throws std::runtime_error if the file cannot be opened or mapped, is invalid,
+         *         or was written with the other byte order (it cannot be used in place)
+         */
+        explicit MappedMatrix(const std::string &path);
+
+        MappedMatrix(const MappedMatrix &other) = delete;
+
+        MappedMatrix &operator=(const MappedMatrix &other) = delete;
+
+        MappedMatrix(MappedMatrix &&other) noexcept;
+
+        MappedMatrix &operator=(MappedMatrix &&other) noexcept;
+
+        ~MappedMatrix();
+
+        int rows() const { return _rows; }
+
+        int cols() const { return _cols; }
+
+        const double *data() const { return _data; }
+
+        /**
+         * @return view of the mapped entries, usable with every Matrix operator without loading a copy
+         */
+        MatrixView view() const;
+
+        /**
+         * @return owning copy of the mapped entries
+         */
+        Matrix toMatrix() const;
+
+        friend std::ostream &operator<<(std::ostream &out, const MappedMatrix &matrix);
+
+    };
+
+}
+#endif //CPP_EX3_MATRIXFILE_HPP
@@ -0,0 +1,232 @@
+#include <algorithm>
+#include <stdexcept>
+#include "MatrixView.hpp"
+#include "Formatter.hpp"
+#include "Gemm.hpp"
+#include "Reduce.hpp"
+#include "Simd.hpp"
+#include "Strassen.hpp"
+#include "Structure.hpp"
+
+using std::size_t;
+
+namespace zich {
+
+    namespace {
+
+        void checkDimensionsEq(const MatrixView &left, const MatrixView &right) {
+            if (left.rows() != right.rows() || left.cols() != right.cols()) {
+                throw std::invalid_argument{"Invalid dimensions for matrix addition or subtraction!"};
+            }
+        }
+
+        /**
+         * Calls op(row_index, first entry of the row) for every row.
+         */
+        template<class Op>
+        void forEachRow(const MatrixView &view, Op op) {
+            for (size_t i = 0; i < static_cast<size_t>(view.rows()); ++i) {
+                op(i, view.data() + i * view.rowStride());
+            }
+        }
+
+    }
+
+    MatrixView::MatrixView(const double *data, int rows, int cols, size_t row_stride, size_t col_stride)
+            : _data{data}, _rows{rows}, _cols{cols}, _row_stride{row_stride}, _col_stride{col_stride} {
+        if (rows < 1 || cols < 1) {
+            throw std::invalid_argument{"Invalid matrix size!"};
+        }
+    }
+
+    MatrixView::MatrixView(const Matrix &matrix)
+            : MatrixView{matrix.data(), matrix.rows(), matrix.cols(), static_cast<size_t>(matrix.cols())} {}
+
+    MatrixView MatrixView::block(int row, int col, int rows, int cols) const {
+        return slice(row, rows, 1, col, cols, 1);
+    }
+
+    MatrixView MatrixView::row(int row) const {
+        return block(row, 0, 1, _cols);
+    }
+
+    MatrixView MatrixView::col(int col) const {
+        return block(0, col, _rows, 1);
+    }
+
+    MatrixView MatrixView::slice(int first_row, int rows, int row_step, int first_col, int cols, int col_step) const {
+        if (first_row < 0 || first_col < 0 || rows < 1 || cols < 1 || row_step < 1 || col_step < 1 ||
+            first_row + (rows - 1) * static_cast<long>(row_step) >= _rows ||
+            first_col + (cols - 1) * static_cast<long>(col_step) >= _cols) {
+            throw std::invalid_argument{"Invalid view dimensions!"};
+        }
+        return MatrixView{at(first_row, first_col), rows, cols,
+                          _row_stride * static_cast<size_t>(row_step), _col_stride * static_cast<size_t>(col_step)};
+    }
+
+    Matrix MatrixView::toMatrix() const {
+        Matrix matrix{{_rows, _cols}, memory::current()};
+        copyTo(matrix._matrix.data());
+        return matrix;
+    }
+
+    void MatrixView::copyTo(double *dst) const {
+        const auto cols = static_cast<size_t>(_cols);
+        forEachRow(*this, [&](size_t i, const double *row) {
+            if (_col_stride == 1) {
+                std::copy(row, row + cols, dst + i * cols);
+            } else {
+                for (size_t j = 0; j < cols; ++j) {
+                    dst[i * cols + j] = row[j * _col_stride];
+                }
+            }
+        });
+    }
+
+    void MatrixView::addTo(double *dst) const {
+        const auto cols = static_cast<size_t>(_cols);
+        if (isContiguous()) {
+            simd::kernels().add(dst, _data, static_cast<size_t>(_rows) * cols);
+            return;
+        }
+        forEachRow(*this, [&](size_t i, const double *row) {
+            if (_col_stride == 1) {
+                simd::kernels().add(dst + i * cols, row, cols);
+            } else {
+                for (size_t j = 0; j < cols; ++j) {
+                    dst[i * cols + j] += row[j * _col_stride];
+                }
+            }
+        });
+    }
+
+    void MatrixView::subtractFrom(double *dst) const {
+        const auto cols = static_cast<size_t>(_cols);
+        if (isContiguous()) {
+            simd::kernels().sub(dst, _data, static_cast<size_t>(_rows) * cols);
+            return;
+        }
+        forEachRow(*this, [&](size_t i, const double *row) {
+            if (_col_stride == 1) {
+                simd::kernels().sub(dst + i * cols, row, cols);
+            } else {
+                for (size_t j = 0; j < cols; ++j) {
+                    dst[i * cols + j] -= row[j * _col_stride];
+                }
+            }
+        });
+    }
+
+    double MatrixView::sum() const {
+        return reduce::sum(*this);
+    }
+
+    bool MatrixView::overlaps(const double *first, const double *last) const {
+        const double *view_last = at(_rows - 1, _cols - 1) + 1;
+        return _data < last && first < view_last;
+    }
+
+    void multiply(const MatrixView &left, const MatrixView &right, double *product, unsigned max_threads) {
+        if (left.cols() != right.rows()) {
+            throw std::invalid_argument{"Invalid dimensions for matrix multiplication!"};
+        }
+        const auto m = static_cast<size_t>(left.rows());
+        const auto k = static_cast<size_t>(left.cols());
+        const auto n = static_cast<size_t>(right.cols());
+        if (structure::multiply(left, right, product)) { // zero or diagonal operand, O(m * n)
+            return;
+        }
+        const strassen::Config strassen_config = strassen::config();
+        if (strassen_config.enabled && left.isContiguous() && right.isContiguous()) {
+            // falls back to the classic kernel below the cutoff
+            strassen::multiply(left.data(), right.data(), product, m, k, n, strassen_config.cutoff, max_threads);
+        } else {
+            gemm::multiply(gemm::Operand{left.data(), left.rowStride(), left.colStride()},
+                           gemm::Operand{right.data(), right.rowStride(), right.colStride()}, product, n, m, k, n,
+                           max_threads);
+        }
+    }
+
+// ****************************************************
+// operators (each returns a new contiguous Matrix)
+// ****************************************************
+
+    Matrix operator+(const MatrixView &left, const MatrixView &right) {
+        checkDimensionsEq(left, right);
+        Matrix sum{{left.rows(), left.cols()}, memory::current()};
+        left.copyTo(sum._matrix.data());
+        right.addTo(sum._matrix.data());
+        return sum;
+    }
+
+    Matrix operator-(const MatrixView &left, const MatrixView &right) {
+        checkDimensionsEq(left, right);
+        Matrix difference{{left.rows(), left.cols()}, memory::current()};
+        left.copyTo(difference._matrix.data());
+        right.subtractFrom(difference._matrix.data());
+        return difference;
+    }
+
+    Matrix operator+(const MatrixView &view) {
+        return view.toMatrix();
+    }
+
+    Matrix operator-(const MatrixView &view) {
+        return view.toMatrix() * -1;
+    }
+
+    Matrix operator*(const MatrixView &view, double scalar) {
+        return view.toMatrix() * scalar;
+    }
+
+    Matrix operator*(double scalar, const MatrixView &view) {
+        return view.toMatrix() * scalar;
+    }
+
+    Matrix operator*(const MatrixView &left, const MatrixView &right) {
+        Matrix product{{left.rows(), right.cols()}, memory::current()};
+        multiply(left, right, product._matrix.data());
+        return product;
+    }
+
+    bool operator==(const MatrixView &left, const MatrixView &right) {
+        checkDimensionsEq(left, right);
+        for (int i = 0; i < left.rows(); ++i) {
+            for (int j = 0; j < left.cols(); ++j) {
+                if (left(i, j) != right(i, j)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool operator!=(const MatrixView &left, const MatrixView &right) {
+        return !(left == right);
+    }
+
+    bool operator<(const MatrixView &left, const MatrixView &right) {
+        checkDimensionsEq(left, right);
+        return left.sum() < right.sum();
+    }
+
+    bool operator>(const MatrixView &left, const MatrixView &right) {
+        checkDimensionsEq(left, right);
+        return left.sum() > right.sum();
+    }
+
+    bool operator<=(const MatrixView &left, const MatrixView &right) {
+        return left < right || left == right;
+    }
+
+    bool operator>=(const MatrixView &left, const MatrixView &right) {
+        return left > right || left == right;
+    }
+
+    std::ostream &operator<<(std::ostream &out, const MatrixView &view) {
+        formatter::write(out, view.data(), static_cast<size_t>(view.rows()), static_cast<size_t>(view.cols()),
+                         view.rowStride(), view.colStride());
+        return out;
+    }
+
+}
@@ -0,0 +1,150 @@
+#ifndef CPP_EX3_MATRIXVIEW_HPP
+#define CPP_EX3_MATRIXVIEW_HPP
+
+#include <cstddef>
+#include <iostream>
+#include "Matrix.hpp"
+
+/*
+ * Non-owning, read-only window into row-major storage: entry (i, j) is data[i * row_stride + j * col_stride].
+ * Blocks, rows, columns and strided slices of a matrix are views of the same buffer, so selecting them copies nothing.
+ * The operators of Matrix accept views, and operations on views return new Matrix objects.
+ * Like std::string_view, a view must not outlive the matrix (or mapped file) it looks into.
+ * https://en.cppreference.com/w/cpp/string/basic_string_view
+ */
+namespace zich {
+
+    class MatrixView {
+
+    private:
+        const double *_data;
+        int _rows;
+        int _cols;
+        std::size_t _row_stride;
+        std::size_t _col_stride;
+
+        const double *at(int row, int col) const {
+            return _data + static_cast<std::size_t>(row) * _row_stride + static_cast<std::size_t>(col) * _col_stride;
+        }
+
+    public:
+        /**
+         * @param row_stride distance between the starts of consecutive rows (the leading dimension)
+         * @param col_stride distance between consecutive entries of a row
+         * @throws std::invalid_argument if a dimension is not positive
+         */
+        MatrixView(const double *data, int rows, int cols, std::size_t row_stride, std::size_t col_stride = 1);
+
+        /**
+         * View of a whole matrix (implicit, so views and matrices mix in every operator).
+         */
+        MatrixView(const Matrix &matrix); // NOLINT(google-explicit-constructor)
+
+        int rows() const { return _rows; }
+
+        int cols() const { return _cols; }
+
+        std::size_t rowStride() const { return _row_stride; }
+
+        std::size_t colStride() const { return _col_stride; }
+
+        const double *data() const { return _data; }
+
+        double operator()(int row, int col) const { return *at(row, col); }
+
+        /**
+         * @return true if the entries are stored row-major with no gaps
+         */
+        bool isContiguous() const {
+            return _col_stride == 1 && (_rows == 1 || _row_stride == static_cast<std::size_t>(_cols));
+        }
+
+        /**
+         * @return (rows x cols) block starting at (row, col)
+         * @throws std::invalid_argument if the block does not fit in this view
+         */
+        MatrixView block(int row, int col, int rows, int cols) const;
+
+        MatrixView row(int row) const;
+
+        MatrixView col(int col) const;
+
+        /**
+         * Every row_step-th row and col_step-th column: rows first_row, first_row + row_step, ... (rows of them),
+         * and the same for columns.
+         * @throws std::invalid_argument if the slice does not fit in this view or a step is not positive
+         */
+        MatrixView slice(int first_row, int rows, int row_step, int first_col, int cols, int col_step) const;
+
+        /**
+         * @return owning contiguous copy
+         */
+        Matrix toMatrix() const;
+
+        /**
+         * Copies the entries row-major into a contiguous buffer of rows() * cols() values.
+         */
+        void copyTo(double *dst) const;
+
+        /**
+         * dst[i] += entry i (row-major order), for a contiguous buffer of rows() * cols() values.
+         */
+        void addTo(double *dst) const;
+
+        /**
+         * dst[i] -= entry i (row-major order).
+         */
+        void subtractFrom(double *dst) const;
+
+        /**
+         * Compensated sum (reduce::sum), the same bits as the Matrix comparisons use on a contiguous copy.
+         */
+        double sum() const;
+
+        /**
+         * @return true if the view may read any address in [first, last)
+         */
+        bool overlaps(const double *first, const double *last) const;
+
+    };
+
+    /**
+     * product = left * right, written to a contiguous row-major (left.rows() x right.cols()) buffer.
+     * Uses the same kernels as Matrix::operator* (strided operands are packed directly, without copies),
+     * including the Strassen-Winograd mode when it is on and both operands are contiguous.
+     * A zero or diagonal operand (times a finite one) takes the O(m * n) path of Structure.hpp instead.
+     * @param max_threads per-call thread cap, 0 = global limit
+     * @throws std::invalid_argument if left.cols() != right.rows()
+     */
+    void multiply(const MatrixView &left, const MatrixView &right, double *product, unsigned max_threads = 0);
+
+    Matrix operator+(const MatrixView &left, const MatrixView &right);
+
+    Matrix operator-(const MatrixView &left, const MatrixView &right);
+
+    Matrix operator+(const MatrixView &view);
+
+    Matrix operator-(const MatrixView &view);
+
+    Matrix operator*(const MatrixView &view, double scalar);
+
+    Matrix operator*(double scalar, const MatrixView &view);
+
+    Matrix operator*(const MatrixView &left, const MatrixView &right);
+
+    bool operator==(const MatrixView &left, const MatrixView &right);
+
+    bool operator!=(const MatrixView &left, const MatrixView &right);
+
+    bool operator<(const MatrixView &left, const MatrixView &right);
+
+    bool operator>(const MatrixView &left, const MatrixView &right);
+
+    bool operator<=(const MatrixView &left, const MatrixView &right);
+
+    bool operator>=(const MatrixView &left, const MatrixView &right);
+
+    std::ostream &operator<<(std::ostream &out, const MatrixView &view);
+
+}
+#endif //CPP_EX3_MATRIXVIEW_HPP
@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <new>
+#include "Memory.hpp"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+using std::size_t;
+
+namespace zich::memory {
+
+    namespace {
+
+        thread_local std::pmr::memory_resource *current_resource = nullptr;
+
+        std::atomic<HugePages> default_huge_pages{HugePages::NONE};
+
+        constexpr size_t CLASSES_PER_OCTAVE = 4;
+
+        // floor(log2(value)) for value > 0
+        size_t log2(size_t value) {
+            return 63 - static_cast<size_t>(__builtin_clzll(value));
+        }
+
+        /*
+         * Classes: 64, then 4 per octave (2^e, 2^(e+1)]: 2^e + k 2^(e-2) for k = 1..4.
+         */
+        size_t sizeClass(size_t bytes) {
+            if (bytes <= PoolResource::MIN_BLOCK) {
+                return 0;
+            }
+            const size_t octave = log2(bytes - 1);
+            const size_t step = size_t{1} << (octave - 2);
+            const size_t k = (bytes - (size_t{1} << octave) + step - 1) / step;
+            return 1 + (octave - log2(PoolResource::MIN_BLOCK)) * CLASSES_PER_OCTAVE + (k - 1);
+        }
+
+        size_t classSize(size_t size_class) {
+            if (size_class == 0) {
+                return PoolResource::MIN_BLOCK;
+            }
+            const size_t octave = log2(PoolResource::MIN_BLOCK) + (size_class - 1) / CLASSES_PER_OCTAVE;
+            const size_t k = (size_class - 1) % CLASSES_PER_OCTAVE + 1;
+            return (size_t{1} << octave) + k * (size_t{1} << (octave - 2));
+        }
+
+        bool pooled(size_t bytes, size_t alignment) {
+            return bytes <= PoolResource::MAX_POOLED && alignment <= ALIGNMENT;
+        }
+
+        size_t roundUp(size_t bytes, size_t multiple) {
+            return (bytes + multiple - 1) / multiple * multiple;
+        }
+
+#if defined(__linux__)
+
+        /*
+         * The kernel only backs 2 MiB-aligned ranges with transparent huge pages, so the mapping is made one
+         * huge page longer and trimmed to an aligned range of exactly length bytes (which munmap then releases).
+         */
+        void *mapTransparent(size_t length) {
+            void *mapping = mmap(nullptr, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mapping == MAP_FAILED) {
+                throw std::bad_alloc{};
+            }
+            auto *first = static_cast<char *>(mapping);
+            auto *start = reinterpret_cast<char *>(roundUp(reinterpret_cast<size_t>(first), HUGE_PAGE_SIZE));
+            if (start != first) {
+                munmap(first, static_cast<size_t>(start - first));
+            }
+            munmap(start + length, HUGE_PAGE_SIZE - static_cast<size_t>(start - first));
+#if defined(MADV_HUGEPAGE)
+            madvise(start, length, MADV_HUGEPAGE); // only advice: the kernel may still use small pages
+#endif
+            return start;
+        }
+
+        void *mapHugePages(size_t length, HugePages huge_pages) {
+#if defined(MAP_HUGETLB)
+            if (huge_pages == HugePages::EXPLICIT) {
+                void *mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                if (mapping != MAP_FAILED) {
+                    return mapping;
+                }
+            }
+#endif
+            return mapTransparent(length);
+        }
+
+#endif
+
+    }
+
+// *******************************
+// AlignedResource and the heaps
+// *******************************
+
+    AlignedResource::AlignedResource(HugePages huge_pages, size_t threshold)
+            : _huge_pages(huge_pages), _threshold(threshold) {}
+
+    /*
+     * Whether a block was mapped only depends on its size and this resource's fixed settings,
+     * so deallocate makes the same choice as allocate without storing anything.
+     */
+    void *AlignedResource::do_allocate(size_t bytes, size_t alignment) {
+#if defined(__linux__)
+        if (_huge_pages != HugePages::NONE && bytes >= _threshold && alignment <= HUGE_PAGE_SIZE) {
+            const size_t length = roundUp(bytes, HUGE_PAGE_SIZE);
+            void *block = mapHugePages(length, _huge_pages);
+            _mapped += length;
+            return block;
+        }
+#endif
+        return ::operator new(bytes, std::align_val_t{std::max(alignment, ALIGNMENT)});
+    }
+
+    void AlignedResource::do_deallocate(void *block, size_t bytes, size_t alignment) {
+#if defined(__linux__)
+        if (_huge_pages != HugePages::NONE && bytes >= _threshold && alignment <= HUGE_PAGE_SIZE) {
+            const size_t length = roundUp(bytes, HUGE_PAGE_SIZE);
+            munmap(block, length);
+            _mapped -= length;
+            return;
+        }
+#endif
+        ::operator delete(block, bytes, std::align_val_t{std::max(alignment, ALIGNMENT)});
+    }
+
+    bool AlignedResource::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource *heap(HugePages huge_pages) {
+        static AlignedResource plain{HugePages::NONE};
+        static AlignedResource transparent{HugePages::TRANSPARENT};
+        static AlignedResource explicit_pages{HugePages::EXPLICIT};
+        switch (huge_pages) {
+            case HugePages::TRANSPARENT:
+                return &transparent;
+            case HugePages::EXPLICIT:
+                return &explicit_pages;
+            default:
+                return &plain;
+        }
+    }
+
+    std::pmr::memory_resource *heap() {
+        return heap(default_huge_pages.load());
+    }
+
+    void setHugePages(HugePages huge_pages) {
+        default_huge_pages = huge_pages;
+    }
+
+    std::pmr::memory_resource *current() {
+        return current_resource == nullptr ? heap() : current_resource;
+    }
+
+// ****************
+// PoolResource
+// ****************
+
+    PoolResource::PoolResource(std::pmr::memory_resource *upstream)
+            : _upstream(upstream), _free(sizeClass(MAX_POOLED) + 1, nullptr) {}
+
+    PoolResource::~PoolResource() {
+        release();
+    }
+
+    size_t PoolResource::blockSize(size_t bytes) {
+        return bytes <= MAX_POOLED ? classSize(sizeClass(bytes)) : bytes;
+    }
+
+    void *PoolResource::do_allocate(size_t bytes, size_t alignment) {
+        if (!pooled(bytes, alignment)) {
+            {
+                std::lock_guard<std::mutex> guard{_lock};
+                ++_stats.allocations;
+            }
+            return _upstream->allocate(bytes, alignment);
+        }
+        const size_t size_class = sizeClass(bytes);
+        {
+            std::lock_guard<std::mutex> guard{_lock};
+            ++_stats.allocations;
+            FreeBlock *block = _free[size_class];
+            if (block != nullptr) {
+                _free[size_class] = block->next;
+                ++_stats.reuses;
+                _stats.cached -= classSize(size_class);
+                return block;
+            }
+        }
+        return _upstream->allocate(classSize(size_class), ALIGNMENT); // outside the lock, it may be slow
+    }
+
+    void PoolResource::do_deallocate(void *block, size_t bytes, size_t alignment) {
+        if (!pooled(bytes, alignment)) {
+            _upstream->deallocate(block, bytes, alignment);
+            return;
+        }
+        const size_t size_class = sizeClass(bytes);
+        auto *free_block = static_cast<FreeBlock *>(block);
+        std::lock_guard<std::mutex> guard{_lock};
+        free_block->next = _free[size_class];
+        _free[size_class] = free_block;
+        _stats.cached += classSize(size_class);
+    }
+
+    bool PoolResource::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+        return this == &other;
+    }
+
+    void PoolResource::release() {
+        std::vector<FreeBlock *> lists;
+        {
+            std::lock_guard<std::mutex> guard{_lock};
+            lists.swap(_free);
+            _free.assign(lists.size(), nullptr);
+            _stats.cached = 0;
+        }
+        for (size_t size_class = 0; size_class < lists.size(); ++size_class) {
+            for (FreeBlock *block = lists[size_class]; block != nullptr;) {
+                FreeBlock *next = block->next;
+                _upstream->deallocate(block, classSize(size_class), ALIGNMENT);
+                block = next;
+            }
+        }
+    }
+
+    PoolResource::Stats PoolResource::stats() const {
+        std::lock_guard<std::mutex> guard{_lock};
+        return _stats;
+    }
+
+// ***************************
+// ScopedResource, ScopedArena
+// ***************************
+
+    ScopedResource::ScopedResource(std::pmr::memory_resource *resource) : _previous(current_resource) {
+        current_resource = resource;
+    }
+
+    ScopedResource::~ScopedResource() {
+        current_resource = _previous;
+    }
+
+    ScopedArena::ScopedArena(std::pmr::memory_resource *upstream) : _pool(upstream), _scope(&_pool) {}
+
+}
@@ -0,0 +1,198 @@
+#ifndef CPP_EX3_MEMORY_HPP
+#define CPP_EX3_MEMORY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+/*
+ * Where matrix buffers come from.
+ * Every new Matrix (including the temporaries of +, -, * and postfix ++/--) takes its buffer from the current
+ * memory resource of the calling thread, which is the aligned heap unless a ScopedResource or ScopedArena is active.
+ * A buffer keeps its resource for life: moves keep it, assignments copy into the buffer the target already has.
+ * https://en.cppreference.com/w/cpp/memory/memory_resource
+ */
+namespace zich::memory {
+
+    // buffer type of Matrix
+    typedef std::pmr::vector<double> Buffer;
+
+    // every matrix buffer starts on a cache line (which is also the width of an AVX-512 register)
+    constexpr std::size_t ALIGNMENT = 64;
+
+    constexpr std::size_t HUGE_PAGE_SIZE = std::size_t{1} << 21;
+
+    /*
+     * Large buffers can be backed by 2 MiB pages, so a multi-GB matrix needs thousands of TLB entries instead
+     * of millions. TRANSPARENT asks the kernel to back the buffer with transparent huge pages (madvise),
+     * EXPLICIT maps pages from the hugetlbfs pool (which the administrator must reserve, see
+     * /proc/sys/vm/nr_hugepages) and falls back to TRANSPARENT when the pool is empty.
+     * https://www.kernel.org/doc/html/latest/admin-guide/mm/transhuge.html
+     * https://www.kernel.org/doc/html/latest/admin-guide/mm/hugetlbpage.html
+     */
+    enum class HugePages {
+        NONE,
+        TRANSPARENT,
+        EXPLICIT
+    };
+
+    /**
+     * Heap memory aligned to ALIGNMENT bytes. With huge pages, requests of at least threshold bytes are mapped
+     * directly (rounded up to whole huge pages) instead of coming from operator new.
+     */
+    class AlignedResource : public std::pmr::memory_resource {
+    public:
+        static constexpr std::size_t DEFAULT_THRESHOLD = 8 * HUGE_PAGE_SIZE; // at most 1/8 of a mapping unused
+
+    private:
+        HugePages _huge_pages;
+        std::size_t _threshold;
+        std::atomic<std::size_t> _mapped{0};
+
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+        void do_deallocate(void *block, std::size_t bytes, std::size_t alignment) override;
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+    public:
+        explicit AlignedResource(HugePages huge_pages = HugePages::NONE, std::size_t threshold = DEFAULT_THRESHOLD);
+
+        AlignedResource(const AlignedResource &) = delete;
+
+        AlignedResource &operator=(const AlignedResource &) = delete;
+
+        HugePages hugePages() const { return _huge_pages; }
+
+        /**
+         * @return bytes currently mapped for huge-page buffers
+         */
+        std::size_t mapped() const { return _mapped; }
+    };
+
+    /**
+     * @return process-wide AlignedResource with the given huge-page mode (and the default threshold)
+     */
+    std::pmr::memory_resource *heap(HugePages huge_pages);
+
+    /**
+     * @return the heap selected with setHugePages (HugePages::NONE at startup)
+     */
+    std::pmr::memory_resource *heap();
+
+    /**
+     * Selects the heap that new matrices use when no other resource is current, for every thread.
+     * Existing buffers keep the resource they came from.
+     * For a single matrix, copy it into the heap of another mode instead: Matrix{matrix, heap(mode)}.
+     */
+    void setHugePages(HugePages huge_pages);
+
+    /**
+     * @return resource for new matrix buffers on this thread (heap() if none is set)
+     */
+    std::pmr::memory_resource *current();
+
+    /**
+     * Thread-safe pool of freed blocks, four size classes per power of two (at most 25% of a block is unused).
+     * Freed blocks are kept for reuse, so a computation that repeatedly creates temporaries of the same sizes
+     * stops calling the upstream allocator after the first round. Blocks are ALIGNMENT-byte aligned.
+     * Requests above MAX_POOLED bytes, or with a larger alignment, go straight to the upstream resource.
+     */
+    class PoolResource : public std::pmr::memory_resource {
+    public:
+        static constexpr std::size_t MIN_BLOCK = 64;
+
+        static constexpr std::size_t MAX_POOLED = std::size_t{1} << 28;
+
+        struct Stats {
+            std::size_t allocations; // calls to allocate
+            std::size_t reuses;      // allocations served from a freed block
+            std::size_t cached;      // bytes in freed blocks, ready for reuse
+        };
+
+    private:
+        struct FreeBlock {
+            FreeBlock *next;
+        };
+
+        std::pmr::memory_resource *_upstream;
+        std::vector<FreeBlock *> _free; // one list per size class
+        Stats _stats{0, 0, 0};
+        mutable std::mutex _lock;
+
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+        void do_deallocate(void *block, std::size_t bytes, std::size_t alignment) override;
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+    public:
+        explicit PoolResource(std::pmr::memory_resource *upstream = heap());
+
+        PoolResource(const PoolResource &) = delete;
+
+        PoolResource &operator=(const PoolResource &) = delete;
+
+        /**
+         * Returns the freed blocks to the upstream resource.
+         * Blocks still in use must be given back before the pool is destroyed.
+         */
+        ~PoolResource() override;
+
+        /**
+         * Returns the freed blocks to the upstream resource (blocks in use are not affected).
+         */
+        void release();
+
+        Stats stats() const;
+
+        /**
+         * @return bytes actually reserved for a request of the given size (its size class)
+         */
+        static std::size_t blockSize(std::size_t bytes);
+    };
+
+    /**
+     * Makes a resource the current one of this thread until the end of the scope (scopes nest).
+     */
+    class ScopedResource {
+    private:
+        std::pmr::memory_resource *_previous;
+
+    public:
+        explicit ScopedResource(std::pmr::memory_resource *resource);
+
+        ScopedResource(const ScopedResource &) = delete;
+
+        ScopedResource &operator=(const ScopedResource &) = delete;
+
+        ~ScopedResource();
+    };
+
+    /**
+     * A PoolResource that is current on this thread for the scope of the arena, and freed with it:
+     *
+     *     Matrix result{...};
+     *     {
+     *         memory::ScopedArena arena;
+     *         result = (a + b) * c - d; // temporaries recycle the arena's blocks, result keeps its own buffer
+     *     }
+     *
+     * Matrices created inside the scope must not outlive it. Copy one out with Matrix(other, resource),
+     * or assign it to a matrix created outside.
+     */
+    class ScopedArena {
+    private:
+        PoolResource _pool;
+        ScopedResource _scope;
+
+    public:
+        explicit ScopedArena(std::pmr::memory_resource *upstream = heap());
+
+        PoolResource &pool() { return _pool; }
+    };
+
+}
+#endif //CPP_EX3_MEMORY_HPP
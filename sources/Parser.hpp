@@ -0,0 +1,230 @@
+#ifndef CPP_EX3_PARSER_HPP
+#define CPP_EX3_PARSER_HPP
+
+#include <charconv>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+/*
+ * Single-pass scanner for the "[1 0 0], [0 1 0], [0 0 1]" input format used by operator>>.
+ * It walks the line once, converts each number in place with std::from_chars and never allocates:
+ * https://en.cppreference.com/w/cpp/utility/from_chars
+ * It accepts exactly what the original regex parser accepted (rows split on a comma followed by one whitespace
+ * character, each row matching \[-?\d+(\.\d+)?(\s-?\d+(\.\d+)?)*\]) and reports the same errors in the same order.
+ * Other element types change only the number grammar: integers are -?\d+, and complex numbers are a real number
+ * optionally followed by a signed imaginary part ("1.5", "-2i", "1.5-2i").
+ */
+namespace zich::parser {
+
+    struct Shape {
+        int rows;
+        int cols;
+    };
+
+    /**
+     * Same set as the regex \s in the "C" locale.
+     */
+    constexpr bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+    }
+
+    constexpr bool isDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    /**
+     * Reads one number at pos (grammar -?\d+(\.\d+)?) and advances pos past it.
+     * @return false if the text at pos is not a number
+     */
+    inline bool scanNumber(std::string_view line, size_t &pos, size_t &start) {
+        start = pos;
+        if (pos < line.size() && line[pos] == '-') {
+            ++pos;
+        }
+        const size_t int_start = pos;
+        while (pos < line.size() && isDigit(line[pos])) {
+            ++pos;
+        }
+        if (pos == int_start) {
+            return false;
+        }
+        if (pos < line.size() && line[pos] == '.') {
+            const size_t frac_start = ++pos;
+            while (pos < line.size() && isDigit(line[pos])) {
+                ++pos;
+            }
+            if (pos == frac_start) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Reads one integer at pos (grammar -?\d+) and advances pos past it.
+     */
+    inline bool scanInteger(std::string_view line, size_t &pos, size_t &start) {
+        start = pos;
+        if (pos < line.size() && line[pos] == '-') {
+            ++pos;
+        }
+        const size_t digits_start = pos;
+        while (pos < line.size() && isDigit(line[pos])) {
+            ++pos;
+        }
+        return pos != digits_start;
+    }
+
+    enum class Read {
+        INVALID,
+        OUT_OF_RANGE,
+        VALUE
+    };
+
+    /**
+     * Reads one entry at pos and advances pos past it.
+     * Floating-point values must be normal numbers (std::stod also rejects results that underflow into the
+     * subnormal range), integers must fit the type.
+     */
+    template<class T>
+    Read readValue(std::string_view line, size_t &pos, T &value) {
+        size_t start;
+        if constexpr (std::is_integral_v<T>) {
+            if (!scanInteger(line, pos, start)) {
+                return Read::INVALID;
+            }
+            const std::from_chars_result result = std::from_chars(line.data() + start, line.data() + pos, value);
+            return result.ec == std::errc::result_out_of_range ? Read::OUT_OF_RANGE : Read::VALUE;
+        } else {
+            if (!scanNumber(line, pos, start)) {
+                return Read::INVALID;
+            }
+            const std::from_chars_result result =
+                    std::from_chars(line.data() + start, line.data() + pos, value, std::chars_format::fixed);
+            if (result.ec == std::errc::result_out_of_range ||
+                (value != 0 && std::fabs(value) < std::numeric_limits<T>::min())) {
+                return Read::OUT_OF_RANGE;
+            }
+            return Read::VALUE;
+        }
+    }
+
+    template<class T>
+    Read readValue(std::string_view line, size_t &pos, std::complex<T> &value) {
+        T first{};
+        const Read read = readValue(line, pos, first);
+        if (read == Read::INVALID) {
+            return read;
+        }
+        if (pos >= line.size()) {
+            value = std::complex<T>{first, 0};
+            return read;
+        }
+        if (line[pos] == 'i') { // imaginary only
+            ++pos;
+            value = std::complex<T>{0, first};
+            return read;
+        }
+        if (line[pos] != '+' && line[pos] != '-') {
+            value = std::complex<T>{first, 0};
+            return read;
+        }
+        if (line[pos] == '+') {
+            ++pos;
+            if (pos >= line.size() || !isDigit(line[pos])) {
+                return Read::INVALID;
+            }
+        }
+        T second{};
+        const Read imaginary_read = readValue(line, pos, second);
+        if (imaginary_read == Read::INVALID || pos >= line.size() || line[pos] != 'i') {
+            return Read::INVALID;
+        }
+        ++pos;
+        value = std::complex<T>{first, second};
+        return read == Read::VALUE ? imaginary_read : read;
+    }
+
+    /**
+     * Scans a whole input line and calls on_value(T) for every entry in row-major order.
+     * Errors, in order of precedence (as in the regex parser):
+     *   any malformed row                                   -> std::runtime_error "Could not parse input!"
+     *   rows with different numbers of ' ' separators       -> std::runtime_error "Invalid column dimensions!"
+     *   a value outside the range of the type               -> std::out_of_range (like std::stod)
+     *   other whitespace between values, or no rows at all  -> std::runtime_error "Error: Matrix size does not ..."
+     * A trailing ", " after the last row is ignored.
+     * @return number of rows and columns
+     */
+    template<class T = double, class OnValue>
+    Shape scan(std::string_view line, OnValue on_value) {
+        int rows = 0;
+        int cols = -1;
+        bool cols_mismatch = false;
+        bool out_of_range = false;
+        bool other_separator = false;
+        size_t pos = 0;
+        do {
+            if (pos >= line.size() || line[pos] != '[') {
+                throw std::runtime_error{"Could not parse input!"};
+            }
+            ++pos;
+            int spaces = 0;
+            while (true) {
+                T value{};
+                const Read read = readValue(line, pos, value);
+                if (read == Read::INVALID) {
+                    throw std::runtime_error{"Could not parse input!"};
+                }
+                if (read == Read::OUT_OF_RANGE) {
+                    out_of_range = true;
+                } else if (!out_of_range) {
+                    on_value(value);
+                }
+                if (pos < line.size() && line[pos] == ']') {
+                    ++pos;
+                    break;
+                }
+                if (pos >= line.size() || !isSpace(line[pos])) {
+                    throw std::runtime_error{"Could not parse input!"};
+                }
+                if (line[pos] == ' ') {
+                    ++spaces;
+                } else {
+                    other_separator = true;
+                }
+                ++pos;
+            }
+            if (cols != -1 && spaces + 1 != cols) {
+                cols_mismatch = true;
+            }
+            cols = spaces + 1;
+            ++rows;
+            if (pos == line.size()) {
+                break;
+            }
+            // rows are separated by a comma and exactly one whitespace character
+            if (line[pos] != ',' || pos + 1 >= line.size() || !isSpace(line[pos + 1])) {
+                throw std::runtime_error{"Could not parse input!"};
+            }
+            pos += 2;
+        } while (pos < line.size());
+
+        if (cols_mismatch) {
+            throw std::runtime_error{"Invalid column dimensions!"};
+        }
+        if (out_of_range) {
+            throw std::out_of_range{"Matrix value out of range!"};
+        }
+        if (other_separator) {
+            throw std::runtime_error{"Error: Matrix size does not match dimensions after parsing!"};
+        }
+        return Shape{rows, cols};
+    }
+
+}
+#endif //CPP_EX3_PARSER_HPP
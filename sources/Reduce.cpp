@@ -0,0 +1,480 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include "Reduce.hpp"
+#include "ThreadPool.hpp"
+
+using std::size_t;
+using std::vector;
+
+// squares must be rounded before they are added (no FMA), or AVX-512 builds would give other bits
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace zich::reduce {
+
+    namespace {
+
+        // below this many entries the chunks are reduced on the calling thread
+        constexpr size_t PARALLEL_SIZE = size_t{1} << 18;
+
+        constexpr size_t CHUNKS_PER_TASK = 16;
+
+        // columns per parallel task of colSums
+        constexpr size_t COLUMN_BLOCK = 256;
+
+        /**
+         * sum + error == a + b exactly (Knuth's TwoSum, no branch, so it vectorizes).
+         */
+        __attribute__((always_inline)) inline void twoSum(double a, double b, double &sum, double &error) {
+            sum = a + b;
+            const double b_part = sum - a;
+            error = (a - (sum - b_part)) + (b - b_part);
+        }
+
+        /**
+         * Compensated partial sum: the real sum is close to sum + error.
+         * abs is the plain sum of absolute values.
+         */
+        struct Partial {
+            double sum;
+            double error;
+            double abs;
+        };
+
+        void addPartial(Partial &total, const Partial &part) {
+            double error = 0;
+            twoSum(total.sum, part.sum, total.sum, error);
+            total.error += error + part.error;
+            total.abs += part.abs;
+        }
+
+        /**
+         * Once a lane overflows or meets a NaN, its error term is NaN; the plain sum is the right answer then.
+         */
+        double finish(const Partial &partial) {
+            return std::isfinite(partial.sum) ? partial.sum + partial.error : partial.sum;
+        }
+
+        struct Extremes {
+            double min;
+            double max;
+            bool nan;
+        };
+
+        void addExtremes(Extremes &total, const Extremes &part) {
+            total.min = part.min < total.min ? part.min : total.min;
+            total.max = part.max > total.max ? part.max : total.max;
+            total.nan = total.nan || part.nan;
+        }
+
+// ****************************************************************
+// chunk kernels (one body, compiled for each instruction set below)
+// ****************************************************************
+
+        /*
+         * Eight doubles as one GCC/Clang vector (one zmm register for AVX-512, two ymm for AVX2, four xmm otherwise).
+         * Two of them hold the LANES partial results, so lane l of every variant sees the same entries.
+         */
+        constexpr size_t VECTOR = 8;
+        static_assert(LANES == 2 * VECTOR, "the kernels keep two vectors of lanes");
+
+        typedef double lanes __attribute__((vector_size(VECTOR * sizeof(double))));
+        typedef long long lane_bits __attribute__((vector_size(VECTOR * sizeof(double))));
+
+        /**
+         * Adds VECTOR entries (or their scaled squares) to the compensated sums of one vector of lanes.
+         */
+        template<bool SQUARES>
+        __attribute__((always_inline)) inline void sumStep(const double *src, double scale, lanes &sums,
+                                                            lanes &errors, lanes &abs) {
+            const lane_bits magnitude = lane_bits{} + 0x7fffffffffffffffLL;
+            lanes values;
+            std::memcpy(&values, src, sizeof(lanes));
+            if (SQUARES) {
+                values *= scale;
+                values *= values;
+            }
+            const lanes sum = sums + values; // twoSum, lane by lane
+            const lanes part = sum - sums;
+            errors += (sums - (sum - part)) + (values - part);
+            sums = sum;
+            abs += reinterpret_cast<lanes>(reinterpret_cast<lane_bits>(values) & magnitude);
+        }
+
+        __attribute__((always_inline)) inline void extremesStep(const double *src, lanes &mins, lanes &maxs,
+                                                                 lane_bits &nans) {
+            lanes values;
+            std::memcpy(&values, src, sizeof(lanes));
+            const lane_bits smaller = values < mins;
+            const lane_bits larger = values > maxs;
+            const lane_bits value_bits = reinterpret_cast<lane_bits>(values);
+            mins = reinterpret_cast<lanes>((value_bits & smaller) | (reinterpret_cast<lane_bits>(mins) & ~smaller));
+            maxs = reinterpret_cast<lanes>((value_bits & larger) | (reinterpret_cast<lane_bits>(maxs) & ~larger));
+            nans |= values != values;
+        }
+
+        /**
+         * Entry i goes to lane i % LANES. With SQUARES, (entry * scale)^2 is summed instead.
+         */
+        template<bool SQUARES>
+        __attribute__((always_inline)) inline Partial sumBody(const double *src, size_t count, double scale) {
+            lanes sums[2] = {};
+            lanes errors[2] = {};
+            lanes abs[2] = {};
+            size_t i = 0;
+            for (; i + LANES <= count; i += LANES) {
+                sumStep<SQUARES>(src + i, scale, sums[0], errors[0], abs[0]);
+                sumStep<SQUARES>(src + i + VECTOR, scale, sums[1], errors[1], abs[1]);
+            }
+            double lane_sums[LANES];
+            double lane_errors[LANES];
+            double lane_abs[LANES];
+            std::memcpy(lane_sums, sums, sizeof(sums));
+            std::memcpy(lane_errors, errors, sizeof(errors));
+            std::memcpy(lane_abs, abs, sizeof(abs));
+            for (size_t lane = 0; i + lane < count; ++lane) {
+                double value = src[i + lane];
+                if (SQUARES) {
+                    value *= scale;
+                    value *= value;
+                }
+                double error = 0;
+                twoSum(lane_sums[lane], value, lane_sums[lane], error);
+                lane_errors[lane] += error;
+                lane_abs[lane] += std::fabs(value);
+            }
+            Partial total{0, 0, 0};
+            for (size_t lane = 0; lane < LANES; ++lane) {
+                addPartial(total, Partial{lane_sums[lane], lane_errors[lane], lane_abs[lane]});
+            }
+            return total;
+        }
+
+        __attribute__((always_inline)) inline Extremes extremesBody(const double *src, size_t count) {
+            const lanes infinity = lanes{} + std::numeric_limits<double>::infinity();
+            lanes mins[2] = {infinity, infinity};
+            lanes maxs[2] = {-infinity, -infinity};
+            lane_bits nans[2] = {};
+            size_t i = 0;
+            for (; i + LANES <= count; i += LANES) {
+                extremesStep(src + i, mins[0], maxs[0], nans[0]);
+                extremesStep(src + i + VECTOR, mins[1], maxs[1], nans[1]);
+            }
+            double lane_mins[LANES];
+            double lane_maxs[LANES];
+            long long lane_nans[LANES];
+            std::memcpy(lane_mins, mins, sizeof(mins));
+            std::memcpy(lane_maxs, maxs, sizeof(maxs));
+            std::memcpy(lane_nans, nans, sizeof(nans));
+            for (size_t lane = 0; i + lane < count; ++lane) {
+                const double value = src[i + lane];
+                lane_mins[lane] = value < lane_mins[lane] ? value : lane_mins[lane];
+                lane_maxs[lane] = value > lane_maxs[lane] ? value : lane_maxs[lane];
+                lane_nans[lane] |= value != value;
+            }
+            Extremes total{lane_mins[0], lane_maxs[0], lane_nans[0] != 0};
+            for (size_t lane = 1; lane < LANES; ++lane) {
+                addExtremes(total, Extremes{lane_mins[lane], lane_maxs[lane], lane_nans[lane] != 0});
+            }
+            return total;
+        }
+
+        typedef Partial (*SumKernel)(const double *src, size_t count, double scale);
+
+        typedef Extremes (*ExtremesKernel)(const double *src, size_t count);
+
+        Partial sumBaseline(const double *src, size_t count, double) {
+            return sumBody<false>(src, count, 1);
+        }
+
+        Partial squaresBaseline(const double *src, size_t count, double scale) {
+            return sumBody<true>(src, count, scale);
+        }
+
+        Extremes extremesBaseline(const double *src, size_t count) {
+            return extremesBody(src, count);
+        }
+
+#if defined(__x86_64__) || defined(__i386__)
+
+        __attribute__((target("avx2"))) Partial sumAvx2(const double *src, size_t count, double) {
+            return sumBody<false>(src, count, 1);
+        }
+
+        __attribute__((target("avx2"))) Partial squaresAvx2(const double *src, size_t count, double scale) {
+            return sumBody<true>(src, count, scale);
+        }
+
+        __attribute__((target("avx2"))) Extremes extremesAvx2(const double *src, size_t count) {
+            return extremesBody(src, count);
+        }
+
+        __attribute__((target("avx512f"))) Partial sumAvx512(const double *src, size_t count, double) {
+            return sumBody<false>(src, count, 1);
+        }
+
+        __attribute__((target("avx512f"))) Partial squaresAvx512(const double *src, size_t count, double scale) {
+            return sumBody<true>(src, count, scale);
+        }
+
+        __attribute__((target("avx512f"))) Extremes extremesAvx512(const double *src, size_t count) {
+            return extremesBody(src, count);
+        }
+
+#endif
+
+        struct Variant {
+            const char *name;
+            SumKernel sum;
+            SumKernel squares;
+            ExtremesKernel extremes;
+        };
+
+        const Variant &selectVariant() {
+            static const Variant baseline{"baseline", sumBaseline, squaresBaseline, extremesBaseline};
+#if defined(__x86_64__) || defined(__i386__)
+            static const Variant avx2{"avx2", sumAvx2, squaresAvx2, extremesAvx2};
+            static const Variant avx512{"avx512", sumAvx512, squaresAvx512, extremesAvx512};
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f")) {
+                return avx512;
+            }
+            if (__builtin_cpu_supports("avx2")) {
+                return avx2;
+            }
+#endif
+            return baseline;
+        }
+
+        const Variant &activeVariant() {
+            static const Variant &selected = selectVariant(); // CPUID is queried only once
+            return selected;
+        }
+
+// ******************
+// chunk traversal
+// ******************
+
+        /**
+         * Entries in row-major order, contiguous or strided.
+         */
+        struct Source {
+            const double *data;
+            size_t rows;
+            size_t cols;
+            size_t row_stride;
+            size_t col_stride;
+
+            explicit Source(const MatrixView &view)
+                    : data{view.data()}, rows{static_cast<size_t>(view.rows())}, cols{static_cast<size_t>(view.cols())},
+                      row_stride{view.rowStride()}, col_stride{view.colStride()} {}
+
+            Source(const double *contiguous, size_t size)
+                    : data{contiguous}, rows{1}, cols{size}, row_stride{size}, col_stride{1} {}
+
+            size_t size() const { return rows * cols; }
+
+            /**
+             * @return entries [first, first + count), in place if they are contiguous, else copied to buffer
+             */
+            const double *range(size_t first, size_t count, double *buffer) const {
+                if (col_stride == 1 && (rows == 1 || row_stride == cols)) {
+                    return data + first;
+                }
+                size_t i = first / cols;
+                size_t j = first % cols;
+                for (size_t e = 0; e < count; ++e) {
+                    buffer[e] = data[i * row_stride + j * col_stride];
+                    if (++j == cols) {
+                        j = 0;
+                        ++i;
+                    }
+                }
+                return buffer;
+            }
+        };
+
+        /**
+         * Runs kernel(entries, count) on every chunk and combines the results in chunk order,
+         * so the outcome is the same whether the chunks ran on one thread or many.
+         */
+        template<class Result, class Kernel, class Combine>
+        Result reduceChunks(const Source &source, Result total, Kernel kernel, Combine combine, unsigned max_threads) {
+            const size_t size = source.size();
+            const size_t chunks = (size + CHUNK - 1) / CHUNK;
+            const auto run = [&](size_t chunk) {
+                thread_local vector<double> buffer(CHUNK);
+                const size_t first = chunk * CHUNK;
+                const size_t count = std::min(CHUNK, size - first);
+                return kernel(source.range(first, count, buffer.data()), count);
+            };
+            if (size < PARALLEL_SIZE) {
+                for (size_t chunk = 0; chunk < chunks; ++chunk) {
+                    combine(total, run(chunk));
+                }
+                return total;
+            }
+            vector<Result> partials(chunks);
+            const size_t tasks = (chunks + CHUNKS_PER_TASK - 1) / CHUNKS_PER_TASK;
+            ThreadPool::instance().parallelFor(tasks, [&](size_t task) {
+                const size_t last = std::min(chunks, (task + 1) * CHUNKS_PER_TASK);
+                for (size_t chunk = task * CHUNKS_PER_TASK; chunk < last; ++chunk) {
+                    partials[chunk] = run(chunk);
+                }
+            }, max_threads);
+            for (const Result &partial: partials) {
+                combine(total, partial);
+            }
+            return total;
+        }
+
+        Partial sumSource(const Source &source, unsigned max_threads, SumKernel kernel = nullptr, double scale = 1) {
+            const SumKernel chunk_kernel = kernel == nullptr ? activeVariant().sum : kernel;
+            return reduceChunks(source, Partial{0, 0, 0}, [&](const double *src, size_t count) {
+                return chunk_kernel(src, count, scale);
+            }, addPartial, max_threads);
+        }
+
+        Extremes extremes(const MatrixView &view, unsigned max_threads) {
+            const ExtremesKernel kernel = activeVariant().extremes;
+            const Extremes none{std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+                                false};
+            return reduceChunks(Source{view}, none, kernel, addExtremes, max_threads);
+        }
+
+        /**
+         * Reduces every row on its own (rows are split across threads, never a single row).
+         */
+        vector<Partial> rowPartials(const MatrixView &view, unsigned max_threads) {
+            const auto rows = static_cast<size_t>(view.rows());
+            const size_t rows_per_task = std::max<size_t>(1, PARALLEL_SIZE / static_cast<size_t>(view.cols()));
+            vector<Partial> partials(rows);
+            ThreadPool::instance().parallelFor((rows + rows_per_task - 1) / rows_per_task, [&](size_t task) {
+                const size_t last = std::min(rows, (task + 1) * rows_per_task);
+                for (size_t i = task * rows_per_task; i < last; ++i) {
+                    partials[i] = sumSource(Source{view.row(static_cast<int>(i))}, 1);
+                }
+            }, max_threads);
+            return partials;
+        }
+
+        /**
+         * Compensated sums down every column (of the absolute values with ABS), a row at a time.
+         */
+        template<bool ABS>
+        vector<double> columnSums(const MatrixView &view, unsigned max_threads) {
+            const auto rows = static_cast<size_t>(view.rows());
+            const auto cols = static_cast<size_t>(view.cols());
+            vector<double> sums(cols, 0.0);
+            vector<double> errors(cols, 0.0);
+            ThreadPool::instance().parallelFor((cols + COLUMN_BLOCK - 1) / COLUMN_BLOCK, [&](size_t task) {
+                const size_t first = task * COLUMN_BLOCK;
+                const size_t last = std::min(cols, first + COLUMN_BLOCK);
+                for (size_t i = 0; i < rows; ++i) {
+                    const double *row = view.data() + i * view.rowStride();
+                    for (size_t j = first; j < last; ++j) {
+                        const double value = ABS ? std::fabs(row[j * view.colStride()]) : row[j * view.colStride()];
+                        double sum = 0;
+                        double error = 0;
+                        twoSum(sums[j], value, sum, error);
+                        sums[j] = sum;
+                        errors[j] += error;
+                    }
+                }
+                for (size_t j = first; j < last; ++j) {
+                    sums[j] = finish(Partial{sums[j], errors[j], 0});
+                }
+            }, rows * cols < PARALLEL_SIZE ? 1 : max_threads);
+            return sums;
+        }
+
+        /**
+         * Largest value, NaN if any value is NaN.
+         */
+        double maxOf(const vector<double> &values) {
+            double largest = -std::numeric_limits<double>::infinity();
+            for (double value: values) {
+                if (std::isnan(value)) {
+                    return value;
+                }
+                largest = std::max(largest, value);
+            }
+            return largest;
+        }
+
+    }
+
+    double sum(const MatrixView &view, unsigned max_threads) {
+        return finish(sumSource(Source{view}, max_threads));
+    }
+
+    double sumWithAbs(const double *data, size_t size, double &abs_sum, unsigned max_threads) {
+        const Partial total = sumSource(Source{data, size}, max_threads);
+        abs_sum = total.abs;
+        return finish(total);
+    }
+
+    double min(const MatrixView &view, unsigned max_threads) {
+        const Extremes found = extremes(view, max_threads);
+        return found.nan ? std::numeric_limits<double>::quiet_NaN() : found.min;
+    }
+
+    double max(const MatrixView &view, unsigned max_threads) {
+        const Extremes found = extremes(view, max_threads);
+        return found.nan ? std::numeric_limits<double>::quiet_NaN() : found.max;
+    }
+
+    double normMax(const MatrixView &view, unsigned max_threads) {
+        const Extremes found = extremes(view, max_threads);
+        return found.nan ? std::numeric_limits<double>::quiet_NaN() : std::max(-found.min, found.max);
+    }
+
+    /*
+     * Entries are scaled by the power of two nearest below the largest one (exact, barring underflow),
+     * so squares of entries above 1e154 do not overflow.
+     */
+    double normFrobenius(const MatrixView &view, unsigned max_threads) {
+        const double largest = normMax(view, max_threads);
+        if (largest == 0 || !std::isfinite(largest)) {
+            return largest;
+        }
+        const int exponent = std::ilogb(largest);
+        const Partial squares = sumSource(Source{view}, max_threads, activeVariant().squares,
+                                          std::ldexp(1.0, -exponent));
+        return std::ldexp(std::sqrt(finish(squares)), exponent);
+    }
+
+    double norm1(const MatrixView &view, unsigned max_threads) {
+        return maxOf(columnSums<true>(view, max_threads));
+    }
+
+    double normInf(const MatrixView &view, unsigned max_threads) {
+        vector<double> row_abs;
+        for (const Partial &partial: rowPartials(view, max_threads)) {
+            row_abs.push_back(partial.abs);
+        }
+        return maxOf(row_abs);
+    }
+
+    vector<double> rowSums(const MatrixView &view, unsigned max_threads) {
+        vector<double> sums;
+        for (const Partial &partial: rowPartials(view, max_threads)) {
+            sums.push_back(finish(partial));
+        }
+        return sums;
+    }
+
+    vector<double> colSums(const MatrixView &view, unsigned max_threads) {
+        return columnSums<false>(view, max_threads);
+    }
+
+    const char *variant() {
+        return activeVariant().name;
+    }
+
+}
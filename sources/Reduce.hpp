@@ -0,0 +1,83 @@
+#ifndef CPP_EX3_REDUCE_HPP
+#define CPP_EX3_REDUCE_HPP
+
+#include <cstddef>
+#include <vector>
+#include "MatrixView.hpp"
+
+/*
+ * Reductions over the entries of a matrix or view: sum, min, max, norms, row and column sums.
+ * Sums are compensated (every addition also keeps its exact rounding error, Neumaier's variant of Kahan summation),
+ * so the result is within about one rounding of the real sum, however many entries there are:
+ * https://en.wikipedia.org/wiki/Kahan_summation_algorithm#Further_enhancements
+ * The entries (in row-major order) are split into fixed chunks of CHUNK values, each reduced in LANES independent
+ * lanes (SIMD registers), and the chunk results are combined in chunk order. The work split never depends on the
+ * thread count or the instruction set, so every result is bitwise reproducible.
+ */
+namespace zich::reduce {
+
+    // entries per chunk, the unit of parallel work
+    constexpr std::size_t CHUNK = 4096;
+
+    // partial sums per chunk (two AVX-512 registers)
+    constexpr std::size_t LANES = 16;
+
+    /**
+     * @param max_threads per-call thread cap, 0 = global limit (the result does not depend on it)
+     * @return compensated sum of the entries
+     */
+    double sum(const MatrixView &view, unsigned max_threads = 0);
+
+    /**
+     * Same bits as sum() over the same values.
+     * @param abs_sum receives the (plain) sum of absolute values, for error bounds
+     */
+    double sumWithAbs(const double *data, std::size_t size, double &abs_sum, unsigned max_threads = 0);
+
+    /**
+     * @return smallest entry, NaN if any entry is NaN
+     */
+    double min(const MatrixView &view, unsigned max_threads = 0);
+
+    /**
+     * @return largest entry, NaN if any entry is NaN
+     */
+    double max(const MatrixView &view, unsigned max_threads = 0);
+
+    /**
+     * @return sqrt of the sum of squares (scaled by a power of two, so it does not overflow early)
+     */
+    double normFrobenius(const MatrixView &view, unsigned max_threads = 0);
+
+    /**
+     * @return largest absolute value of an entry
+     */
+    double normMax(const MatrixView &view, unsigned max_threads = 0);
+
+    /**
+     * @return largest column sum of absolute values (the operator 1-norm)
+     */
+    double norm1(const MatrixView &view, unsigned max_threads = 0);
+
+    /**
+     * @return largest row sum of absolute values (the operator infinity-norm)
+     */
+    double normInf(const MatrixView &view, unsigned max_threads = 0);
+
+    /**
+     * @return compensated sum of every row (rows() values)
+     */
+    std::vector<double> rowSums(const MatrixView &view, unsigned max_threads = 0);
+
+    /**
+     * @return compensated sum of every column (cols() values)
+     */
+    std::vector<double> colSums(const MatrixView &view, unsigned max_threads = 0);
+
+    /**
+     * @return name of the chunk kernel in use ("avx512", "avx2" or "baseline")
+     */
+    const char *variant();
+
+}
+#endif //CPP_EX3_REDUCE_HPP
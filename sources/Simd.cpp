@@ -0,0 +1,241 @@
+#include <cstring>
+#include "Simd.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ZICH_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+using std::size_t;
+
+namespace zich::simd {
+
+    namespace {
+
+// *********
+// scalar
+// *********
+
+        void addScalar(double *dst, const double *src, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                dst[i] += src[i];
+            }
+        }
+
+        void subScalar(double *dst, const double *src, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                dst[i] -= src[i];
+            }
+        }
+
+        void rsubScalar(double *dst, const double *src, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                dst[i] = src[i] - dst[i];
+            }
+        }
+
+        void scaleScalar(double *dst, double scalar, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                dst[i] *= scalar;
+            }
+        }
+
+        void shiftScalar(double *dst, double value, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                dst[i] += value;
+            }
+        }
+
+        const Kernels scalar_kernels{"scalar", addScalar, subScalar, rsubScalar, scaleScalar, shiftScalar};
+
+#ifdef ZICH_SIMD_X86
+
+// *********
+// SSE2 (2 doubles per register)
+// *********
+
+        __attribute__((target("sse2"))) void addSse2(double *dst, const double *src, size_t size) {
+            size_t i = 0;
+            for (; i + 2 <= size; i += 2) {
+                _mm_storeu_pd(dst + i, _mm_add_pd(_mm_loadu_pd(dst + i), _mm_loadu_pd(src + i)));
+            }
+            addScalar(dst + i, src + i, size - i);
+        }
+
+        __attribute__((target("sse2"))) void subSse2(double *dst, const double *src, size_t size) {
+            size_t i = 0;
+            for (; i + 2 <= size; i += 2) {
+                _mm_storeu_pd(dst + i, _mm_sub_pd(_mm_loadu_pd(dst + i), _mm_loadu_pd(src + i)));
+            }
+            subScalar(dst + i, src + i, size - i);
+        }
+
+        __attribute__((target("sse2"))) void rsubSse2(double *dst, const double *src, size_t size) {
+            size_t i = 0;
+            for (; i + 2 <= size; i += 2) {
+                _mm_storeu_pd(dst + i, _mm_sub_pd(_mm_loadu_pd(src + i), _mm_loadu_pd(dst + i)));
+            }
+            rsubScalar(dst + i, src + i, size - i);
+        }
+
+        __attribute__((target("sse2"))) void scaleSse2(double *dst, double scalar, size_t size) {
+            const __m128d factor = _mm_set1_pd(scalar);
+            size_t i = 0;
+            for (; i + 2 <= size; i += 2) {
+                _mm_storeu_pd(dst + i, _mm_mul_pd(_mm_loadu_pd(dst + i), factor));
+            }
+            scaleScalar(dst + i, scalar, size - i);
+        }
+
+        __attribute__((target("sse2"))) void shiftSse2(double *dst, double value, size_t size) {
+            const __m128d offset = _mm_set1_pd(value);
+            size_t i = 0;
+            for (; i + 2 <= size; i += 2) {
+                _mm_storeu_pd(dst + i, _mm_add_pd(_mm_loadu_pd(dst + i), offset));
+            }
+            shiftScalar(dst + i, value, size - i);
+        }
+
+        const Kernels sse2_kernels{"sse2", addSse2, subSse2, rsubSse2, scaleSse2, shiftSse2};
+
+// *********
+// AVX2 (4 doubles per register)
+// *********
+
+        __attribute__((target("avx2"))) void addAvx2(double *dst, const double *src, size_t size) {
+            size_t i = 0;
+            for (; i + 4 <= size; i += 4) {
+                _mm256_storeu_pd(dst + i, _mm256_add_pd(_mm256_loadu_pd(dst + i), _mm256_loadu_pd(src + i)));
+            }
+            addScalar(dst + i, src + i, size - i);
+        }
+
+        __attribute__((target("avx2"))) void subAvx2(double *dst, const double *src, size_t size) {
+            size_t i = 0;
+            for (; i + 4 <= size; i += 4) {
+                _mm256_storeu_pd(dst + i, _mm256_sub_pd(_mm256_loadu_pd(dst + i), _mm256_loadu_pd(src + i)));
+            }
+            subScalar(dst + i, src + i, size - i);
+        }
+
+        __attribute__((target("avx2"))) void rsubAvx2(double *dst, const double *src, size_t size) {
+            size_t i = 0;
+            for (; i + 4 <= size; i += 4) {
+                _mm256_storeu_pd(dst + i, _mm256_sub_pd(_mm256_loadu_pd(src + i), _mm256_loadu_pd(dst + i)));
+            }
+            rsubScalar(dst + i, src + i, size - i);
+        }
+
+        __attribute__((target("avx2"))) void scaleAvx2(double *dst, double scalar, size_t size) {
+            const __m256d factor = _mm256_set1_pd(scalar);
+            size_t i = 0;
+            for (; i + 4 <= size; i += 4) {
+                _mm256_storeu_pd(dst + i, _mm256_mul_pd(_mm256_loadu_pd(dst + i), factor));
+            }
+            scaleScalar(dst + i, scalar, size - i);
+        }
+
+        __attribute__((target("avx2"))) void shiftAvx2(double *dst, double value, size_t size) {
+            const __m256d offset = _mm256_set1_pd(value);
+            size_t i = 0;
+            for (; i + 4 <= size; i += 4) {
+                _mm256_storeu_pd(dst + i, _mm256_add_pd(_mm256_loadu_pd(dst + i), offset));
+            }
+            shiftScalar(dst + i, value, size - i);
+        }
+
+        const Kernels avx2_kernels{"avx2", addAvx2, subAvx2, rsubAvx2, scaleAvx2, shiftAvx2};
+
+// *********
+// AVX-512 (8 doubles per register)
+// *********
+
+        __attribute__((target("avx512f"))) void addAvx512(double *dst, const double *src, size_t size) {
+            size_t i = 0;
+            for (; i + 8 <= size; i += 8) {
+                _mm512_storeu_pd(dst + i, _mm512_add_pd(_mm512_loadu_pd(dst + i), _mm512_loadu_pd(src + i)));
+            }
+            addScalar(dst + i, src + i, size - i);
+        }
+
+        __attribute__((target("avx512f"))) void subAvx512(double *dst, const double *src, size_t size) {
+            size_t i = 0;
+            for (; i + 8 <= size; i += 8) {
+                _mm512_storeu_pd(dst + i, _mm512_sub_pd(_mm512_loadu_pd(dst + i), _mm512_loadu_pd(src + i)));
+            }
+            subScalar(dst + i, src + i, size - i);
+        }
+
+        __attribute__((target("avx512f"))) void rsubAvx512(double *dst, const double *src, size_t size) {
+            size_t i = 0;
+            for (; i + 8 <= size; i += 8) {
+                _mm512_storeu_pd(dst + i, _mm512_sub_pd(_mm512_loadu_pd(src + i), _mm512_loadu_pd(dst + i)));
+            }
+            rsubScalar(dst + i, src + i, size - i);
+        }
+
+        __attribute__((target("avx512f"))) void scaleAvx512(double *dst, double scalar, size_t size) {
+            const __m512d factor = _mm512_set1_pd(scalar);
+            size_t i = 0;
+            for (; i + 8 <= size; i += 8) {
+                _mm512_storeu_pd(dst + i, _mm512_mul_pd(_mm512_loadu_pd(dst + i), factor));
+            }
+            scaleScalar(dst + i, scalar, size - i);
+        }
+
+        __attribute__((target("avx512f"))) void shiftAvx512(double *dst, double value, size_t size) {
+            const __m512d offset = _mm512_set1_pd(value);
+            size_t i = 0;
+            for (; i + 8 <= size; i += 8) {
+                _mm512_storeu_pd(dst + i, _mm512_add_pd(_mm512_loadu_pd(dst + i), offset));
+            }
+            shiftScalar(dst + i, value, size - i);
+        }
+
+        const Kernels avx512_kernels{"avx512", addAvx512, subAvx512, rsubAvx512, scaleAvx512, shiftAvx512};
+
+#endif
+
+        const Kernels &select() {
+#ifdef ZICH_SIMD_X86
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f")) {
+                return avx512_kernels;
+            }
+            if (__builtin_cpu_supports("avx2")) {
+                return avx2_kernels;
+            }
+            if (__builtin_cpu_supports("sse2")) {
+                return sse2_kernels;
+            }
+#endif
+            return scalar_kernels;
+        }
+
+    }
+
+    const Kernels &kernels() {
+        static const Kernels &selected = select(); // CPUID is queried only once
+        return selected;
+    }
+
+    const Kernels *find(const char *name) {
+        if (std::strcmp(name, "scalar") == 0) {
+            return &scalar_kernels;
+        }
+#ifdef ZICH_SIMD_X86
+        __builtin_cpu_init();
+        if (std::strcmp(name, "sse2") == 0 && __builtin_cpu_supports("sse2")) {
+            return &sse2_kernels;
+        }
+        if (std::strcmp(name, "avx2") == 0 && __builtin_cpu_supports("avx2")) {
+            return &avx2_kernels;
+        }
+        if (std::strcmp(name, "avx512") == 0 && __builtin_cpu_supports("avx512f")) {
+            return &avx512_kernels;
+        }
+#endif
+        return nullptr;
+    }
+
+}
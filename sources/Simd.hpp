@@ -0,0 +1,40 @@
+#ifndef CPP_EX3_SIMD_HPP
+#define CPP_EX3_SIMD_HPP
+
+#include <cstddef>
+
+/*
+ * Hand-vectorized elementwise kernels with runtime dispatch.
+ * The best variant supported by the CPU (AVX-512, AVX2, SSE2 or plain scalar) is picked once via CPUID,
+ * so a binary built without -march flags still uses the widest registers of the host.
+ * https://gcc.gnu.org/onlinedocs/gcc/x86-Built-in-Functions.html (__builtin_cpu_supports)
+ */
+namespace zich::simd {
+
+    struct Kernels {
+        const char *name;
+
+        void (*add)(double *dst, const double *src, std::size_t size); // dst[i] += src[i]
+
+        void (*sub)(double *dst, const double *src, std::size_t size); // dst[i] -= src[i]
+
+        void (*rsub)(double *dst, const double *src, std::size_t size); // dst[i] = src[i] - dst[i]
+
+        void (*scale)(double *dst, double scalar, std::size_t size); // dst[i] *= scalar
+
+        void (*shift)(double *dst, double value, std::size_t size); // dst[i] += value
+    };
+
+    /**
+     * @return kernels for the widest instruction set of this CPU (selected on first call)
+     */
+    const Kernels &kernels();
+
+    /**
+     * @param name "avx512", "avx2", "sse2" or "scalar"
+     * @return the variant with this name, or nullptr if the CPU (or the build) does not support it
+     */
+    const Kernels *find(const char *name);
+
+}
+#endif //CPP_EX3_SIMD_HPP
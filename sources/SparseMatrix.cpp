@@ -0,0 +1,309 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include "SparseMatrix.hpp"
+#include "Formatter.hpp"
+#include "Parser.hpp"
+#include "ThreadPool.hpp"
+
+using std::size_t;
+using std::vector;
+
+namespace zich {
+
+    namespace {
+
+        // multiply-adds per parallel task of the products with a dense result
+        constexpr size_t PARALLEL_WORK = size_t{1} << 16;
+
+        /**
+         * Runs body(first, last) over [0, count) in chunks of about PARALLEL_WORK / work_per_item items.
+         */
+        template<class Body>
+        void forChunks(size_t count, size_t work_per_item, Body body) {
+            const size_t chunk = std::max<size_t>(1, PARALLEL_WORK / std::max<size_t>(1, work_per_item));
+            const size_t tasks = (count + chunk - 1) / chunk;
+            ThreadPool::instance().parallelFor(tasks, [&](size_t task) {
+                body(task * chunk, std::min(count, (task + 1) * chunk));
+            });
+        }
+
+    }
+
+    SparseMatrix::SparseMatrix(int rows, int cols, Format format)
+            : _format{format}, _rows{rows}, _cols{cols} {
+        if (rows < 1 || cols < 1) {
+            throw std::invalid_argument{"Invalid matrix size!"};
+        }
+        _offsets.assign(groups() + 1, 0);
+    }
+
+    SparseMatrix::SparseMatrix(Format format, int rows, int cols, vector<size_t> offsets, vector<int> indices,
+                               vector<double> values)
+            : _format{format}, _rows{rows}, _cols{cols}, _offsets{std::move(offsets)}, _indices{std::move(indices)},
+              _values{std::move(values)} {
+        if (rows < 1 || cols < 1) {
+            throw std::invalid_argument{"Invalid matrix size!"};
+        }
+        checkStructure();
+    }
+
+    SparseMatrix::SparseMatrix(const MatrixView &dense, Format format)
+            : SparseMatrix{dense.rows(), dense.cols(), format} {
+        const bool by_row = format == Format::CSR;
+        const int outer_size = by_row ? _rows : _cols;
+        const int inner_size = by_row ? _cols : _rows;
+        for (int outer = 0; outer < outer_size; ++outer) {
+            for (int inner = 0; inner < inner_size; ++inner) {
+                const double value = by_row ? dense(outer, inner) : dense(inner, outer);
+                if (value != 0) {
+                    _indices.push_back(inner);
+                    _values.push_back(value);
+                }
+            }
+            _offsets[static_cast<size_t>(outer) + 1] = _values.size();
+        }
+    }
+
+    size_t SparseMatrix::groups() const {
+        return static_cast<size_t>(_format == Format::CSR ? _rows : _cols);
+    }
+
+    void SparseMatrix::checkStructure() const {
+        const size_t count = groups();
+        const int index_limit = _format == Format::CSR ? _cols : _rows;
+        if (_offsets.size() != count + 1 || _offsets.front() != 0 || _offsets.back() != _values.size() ||
+            _indices.size() != _values.size()) {
+            throw std::invalid_argument{"Invalid sparse matrix structure!"};
+        }
+        for (size_t g = 0; g < count; ++g) {
+            if (_offsets[g] > _offsets[g + 1]) {
+                throw std::invalid_argument{"Invalid sparse matrix structure!"};
+            }
+            for (size_t e = _offsets[g]; e < _offsets[g + 1]; ++e) {
+                if (_indices[e] < 0 || _indices[e] >= index_limit || (e > _offsets[g] && _indices[e - 1] >= _indices[e])) {
+                    throw std::invalid_argument{"Invalid sparse matrix structure!"};
+                }
+            }
+        }
+    }
+
+    double SparseMatrix::operator()(int row, int col) const {
+        if (row < 0 || row >= _rows || col < 0 || col >= _cols) {
+            throw std::out_of_range{"Index out of range!"};
+        }
+        const auto group = static_cast<size_t>(_format == Format::CSR ? row : col);
+        const int index = _format == Format::CSR ? col : row;
+        const auto first = _indices.begin() + static_cast<long>(_offsets[group]);
+        const auto last = _indices.begin() + static_cast<long>(_offsets[group + 1]);
+        const auto found = std::lower_bound(first, last, index);
+        if (found == last || *found != index) {
+            return 0;
+        }
+        return _values[static_cast<size_t>(found - _indices.begin())];
+    }
+
+    /*
+     * Counting sort by the other index: O(nonzeros + rows + cols), and the new groups come out sorted.
+     */
+    SparseMatrix SparseMatrix::toFormat(Format format) const {
+        if (format == _format) {
+            return *this;
+        }
+        SparseMatrix converted{_rows, _cols, format};
+        const size_t new_groups = converted.groups();
+        for (int index: _indices) {
+            ++converted._offsets[static_cast<size_t>(index) + 1];
+        }
+        for (size_t g = 0; g < new_groups; ++g) {
+            converted._offsets[g + 1] += converted._offsets[g];
+        }
+        converted._indices.resize(_values.size());
+        converted._values.resize(_values.size());
+        vector<size_t> next(converted._offsets.begin(), converted._offsets.end() - 1);
+        for (size_t g = 0; g < groups(); ++g) {
+            for (size_t e = _offsets[g]; e < _offsets[g + 1]; ++e) {
+                const size_t dst = next[static_cast<size_t>(_indices[e])]++;
+                converted._indices[dst] = static_cast<int>(g);
+                converted._values[dst] = _values[e];
+            }
+        }
+        return converted;
+    }
+
+    Matrix SparseMatrix::toMatrix() const {
+        const auto cols = static_cast<size_t>(_cols);
+        Matrix matrix{{_rows, _cols}, memory::current()}; // zeros
+        double *dense = matrix._matrix.data();
+        for (size_t g = 0; g < groups(); ++g) {
+            for (size_t e = _offsets[g]; e < _offsets[g + 1]; ++e) {
+                const auto index = static_cast<size_t>(_indices[e]);
+                dense[_format == Format::CSR ? g * cols + index : index * cols + g] = _values[e];
+            }
+        }
+        return matrix;
+    }
+
+    /*
+     * Gustavson: row i of the product is the sum of A(i, k) * (row k of B) over the nonzeros of row i of A.
+     * A dense accumulator with a marker per column collects each row, then its nonzero columns are sorted.
+     */
+    SparseMatrix SparseMatrix::operator*(const SparseMatrix &other) const {
+        if (_cols != other._rows) {
+            throw std::invalid_argument{"Invalid dimensions for matrix multiplication!"};
+        }
+        const SparseMatrix left{_format == Format::CSR ? *this : toFormat(Format::CSR)};
+        const SparseMatrix right{other._format == Format::CSR ? other : other.toFormat(Format::CSR)};
+        SparseMatrix product{_rows, other._cols, Format::CSR};
+        vector<double> accumulator(static_cast<size_t>(other._cols), 0.0);
+        vector<int> marker(static_cast<size_t>(other._cols), -1);
+        vector<int> row_cols;
+        for (size_t i = 0; i < static_cast<size_t>(_rows); ++i) {
+            row_cols.clear();
+            for (size_t e = left._offsets[i]; e < left._offsets[i + 1]; ++e) {
+                const auto k = static_cast<size_t>(left._indices[e]);
+                const double a_ik = left._values[e];
+                for (size_t f = right._offsets[k]; f < right._offsets[k + 1]; ++f) {
+                    const int j = right._indices[f];
+                    const auto col = static_cast<size_t>(j);
+                    if (marker[col] != static_cast<int>(i)) {
+                        marker[col] = static_cast<int>(i);
+                        accumulator[col] = 0;
+                        row_cols.push_back(j);
+                    }
+                    accumulator[col] += a_ik * right._values[f];
+                }
+            }
+            std::sort(row_cols.begin(), row_cols.end());
+            for (int j: row_cols) {
+                const double value = accumulator[static_cast<size_t>(j)];
+                if (value != 0) {
+                    product._indices.push_back(j);
+                    product._values.push_back(value);
+                }
+            }
+            product._offsets[i + 1] = product._values.size();
+        }
+        return product;
+    }
+
+    /*
+     * CSR: row i of the product is the sum of S(i, k) * (row k of D).
+     * CSC: column k of S scatters S(i, k) * (row k of D) into the rows i of the product (k increases, as above).
+     */
+    Matrix operator*(const SparseMatrix &sparse, const MatrixView &dense) {
+        if (sparse._cols != dense.rows()) {
+            throw std::invalid_argument{"Invalid dimensions for matrix multiplication!"};
+        }
+        const auto n = static_cast<size_t>(dense.cols());
+        Matrix result{{sparse._rows, dense.cols()}, memory::current()}; // zeros
+        double *product = result._matrix.data();
+        const auto add_row = [&](double *dst, double scale, size_t k) {
+            const double *src = dense.data() + k * dense.rowStride();
+            for (size_t j = 0; j < n; ++j) {
+                dst[j] += scale * src[j * dense.colStride()];
+            }
+        };
+        if (sparse._format == SparseMatrix::Format::CSR) {
+            const size_t work = std::max<size_t>(1, sparse.nonZeros() / static_cast<size_t>(sparse._rows)) * n;
+            forChunks(static_cast<size_t>(sparse._rows), work, [&](size_t first, size_t last) {
+                for (size_t i = first; i < last; ++i) {
+                    for (size_t e = sparse._offsets[i]; e < sparse._offsets[i + 1]; ++e) {
+                        add_row(product + i * n, sparse._values[e], static_cast<size_t>(sparse._indices[e]));
+                    }
+                }
+            });
+        } else {
+            for (size_t k = 0; k < static_cast<size_t>(sparse._cols); ++k) {
+                for (size_t e = sparse._offsets[k]; e < sparse._offsets[k + 1]; ++e) {
+                    add_row(product + static_cast<size_t>(sparse._indices[e]) * n, sparse._values[e], k);
+                }
+            }
+        }
+        return result;
+    }
+
+    /*
+     * CSR: row i of the product is the sum of D(i, k) * (row k of S).
+     * CSC: entry (i, j) of the product is the dot product of row i of D with column j of S.
+     */
+    Matrix operator*(const MatrixView &dense, const SparseMatrix &sparse) {
+        if (dense.cols() != sparse._rows) {
+            throw std::invalid_argument{"Invalid dimensions for matrix multiplication!"};
+        }
+        const auto m = static_cast<size_t>(dense.rows());
+        const auto n = static_cast<size_t>(sparse._cols);
+        Matrix result{{dense.rows(), sparse._cols}, memory::current()}; // zeros
+        double *product = result._matrix.data();
+        forChunks(m, std::max<size_t>(1, sparse.nonZeros()), [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                const double *row = dense.data() + i * dense.rowStride();
+                double *dst = product + i * n;
+                for (size_t g = 0; g < sparse.groups(); ++g) {
+                    for (size_t e = sparse._offsets[g]; e < sparse._offsets[g + 1]; ++e) {
+                        const auto index = static_cast<size_t>(sparse._indices[e]);
+                        if (sparse._format == SparseMatrix::Format::CSR) { // g = k, index = j
+                            dst[index] += row[g * dense.colStride()] * sparse._values[e];
+                        } else { // g = j, index = k
+                            dst[g] += row[index * dense.colStride()] * sparse._values[e];
+                        }
+                    }
+                }
+            }
+        });
+        return result;
+    }
+
+    std::ostream &operator<<(std::ostream &out, const SparseMatrix &matrix) {
+        const SparseMatrix by_row{matrix.toFormat(SparseMatrix::Format::CSR)};
+        vector<double> row(static_cast<size_t>(matrix._cols));
+        for (size_t i = 0; i < static_cast<size_t>(matrix._rows); ++i) {
+            std::fill(row.begin(), row.end(), 0.0);
+            for (size_t e = by_row._offsets[i]; e < by_row._offsets[i + 1]; ++e) {
+                row[static_cast<size_t>(by_row._indices[e])] = by_row._values[e];
+            }
+            formatter::write(out, row.data(), 1, row.size());
+            if (i < static_cast<size_t>(matrix._rows) - 1) {
+                out << '\n';
+            }
+        }
+        return out;
+    }
+
+    /*
+     * The scanner reports values in row-major order; only the flat positions of nonzeros are kept
+     * until the number of columns is known.
+     */
+    std::istream &operator>>(std::istream &in, SparseMatrix &matrix) {
+        thread_local std::string str_input; // keeps its capacity between calls
+        getline(in, str_input);
+
+        size_t position = 0;
+        vector<size_t> positions;
+        vector<double> values;
+        const parser::Shape shape = parser::scan(str_input, [&](double value) {
+            if (value != 0) {
+                positions.push_back(position);
+                values.push_back(value);
+            }
+            ++position;
+        });
+
+        const auto cols = static_cast<size_t>(shape.cols);
+        vector<size_t> offsets(static_cast<size_t>(shape.rows) + 1, 0);
+        vector<int> indices(positions.size());
+        for (size_t e = 0; e < positions.size(); ++e) {
+            ++offsets[positions[e] / cols + 1];
+            indices[e] = static_cast<int>(positions[e] % cols);
+        }
+        for (size_t i = 0; i < static_cast<size_t>(shape.rows); ++i) {
+            offsets[i + 1] += offsets[i];
+        }
+        SparseMatrix parsed{SparseMatrix::Format::CSR, shape.rows, shape.cols, std::move(offsets), std::move(indices),
+                            std::move(values)};
+        matrix = parsed.toFormat(matrix._format);
+        return in;
+    }
+
+}
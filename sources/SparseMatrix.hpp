@@ -0,0 +1,108 @@
+#ifndef CPP_EX3_SPARSEMATRIX_HPP
+#define CPP_EX3_SPARSEMATRIX_HPP
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+#include "Matrix.hpp"
+#include "MatrixView.hpp"
+
+/*
+ * Sparse matrix in compressed sparse row (CSR) or compressed sparse column (CSC) form:
+ * https://en.wikipedia.org/wiki/Sparse_matrix#Compressed_sparse_row_(CSR,_CRS_or_Yale_format)
+ * Only the nonzero entries are stored, so memory and multiplication work scale with their number.
+ * Within each row (CSR) or column (CSC) the entries are sorted by index. Products skip the zero terms, so they
+ * match the dense product up to rounding (and exactly where no rounding happens, e.g. small integers), unless a
+ * skipped zero would have met an infinity or NaN.
+ */
+namespace zich {
+
+    class SparseMatrix {
+
+    public:
+        enum class Format {
+            CSR, // entries grouped by row, indices are columns
+            CSC  // entries grouped by column, indices are rows
+        };
+
+    private:
+        Format _format;
+        int _rows;
+        int _cols;
+        std::vector<std::size_t> _offsets; // entries of group g are [_offsets[g], _offsets[g + 1])
+        std::vector<int> _indices;
+        std::vector<double> _values;
+
+        std::size_t groups() const;
+
+        void checkStructure() const;
+
+    public:
+        /**
+         * Zero matrix.
+         * @throws std::invalid_argument if a dimension is not positive
+         */
+        SparseMatrix(int rows, int cols, Format format = Format::CSR);
+
+        /**
+         * Takes compressed arrays as they are (offsets has rows + 1 entries for CSR, cols + 1 for CSC).
+         * @throws std::invalid_argument if the arrays are inconsistent or indices are out of range or unsorted
+         */
+        SparseMatrix(Format format, int rows, int cols, std::vector<std::size_t> offsets, std::vector<int> indices,
+                     std::vector<double> values);
+
+        /**
+         * Keeps the nonzero entries of a dense matrix (or view).
+         */
+        explicit SparseMatrix(const MatrixView &dense, Format format = Format::CSR);
+
+        int rows() const { return _rows; }
+
+        int cols() const { return _cols; }
+
+        Format format() const { return _format; }
+
+        std::size_t nonZeros() const { return _values.size(); }
+
+        const std::vector<std::size_t> &offsets() const { return _offsets; }
+
+        const std::vector<int> &indices() const { return _indices; }
+
+        const std::vector<double> &values() const { return _values; }
+
+        /**
+         * @return entry (row, col), found by binary search in its row or column
+         */
+        double operator()(int row, int col) const;
+
+        /**
+         * @return the same matrix in the given format (O(nonzeros) conversion, or a copy if it already is)
+         */
+        SparseMatrix toFormat(Format format) const;
+
+        Matrix toMatrix() const;
+
+        /**
+         * Sparse x sparse (Gustavson's row-by-row algorithm). The result is CSR, entries that cancel out are dropped.
+         */
+        SparseMatrix operator*(const SparseMatrix &other) const;
+
+        friend Matrix operator*(const SparseMatrix &sparse, const MatrixView &dense);
+
+        friend Matrix operator*(const MatrixView &dense, const SparseMatrix &sparse);
+
+        /**
+         * Same text format as Matrix (zeros included).
+         */
+        friend std::ostream &operator<<(std::ostream &out, const SparseMatrix &matrix);
+
+        /**
+         * Parses the Matrix text format ("[1 0 0], [0 1 0], [0 0 1]") with the same errors, storing only nonzeros.
+         * The matrix keeps its format.
+         */
+        friend std::istream &operator>>(std::istream &in, SparseMatrix &matrix);
+
+    };
+
+}
+#endif //CPP_EX3_SPARSEMATRIX_HPP
@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+#include "Strassen.hpp"
+#include "Gemm.hpp"
+#include "Matrix.hpp"
+
+using std::size_t;
+
+namespace zich::strassen {
+
+    namespace {
+
+        std::atomic<bool> enabled_flag{false};
+        std::atomic<size_t> cutoff_size{DEFAULT_CUTOFF};
+
+        /**
+         * Read-only row-major block inside a larger buffer (ld = distance between rows).
+         */
+        struct View {
+            const double *data;
+            size_t ld;
+
+            const double *at(size_t row, size_t col) const { return data + row * ld + col; }
+        };
+
+        /**
+         * Writable row-major block.
+         */
+        struct Block {
+            double *data;
+            size_t ld;
+
+            double *at(size_t row, size_t col) const { return data + row * ld + col; }
+
+            operator View() const { return View{data, ld}; } // NOLINT(google-explicit-constructor)
+        };
+
+        /**
+         * dst = x + sign * y, elementwise over a (rows x cols) block.
+         */
+        void combine(Block dst, View x, View y, double sign, size_t rows, size_t cols) {
+            for (size_t i = 0; i < rows; ++i) {
+                const double *x_row = x.at(i, 0);
+                const double *y_row = y.at(i, 0);
+                double *dst_row = dst.at(i, 0);
+                if (sign > 0) {
+                    for (size_t j = 0; j < cols; ++j) {
+                        dst_row[j] = x_row[j] + y_row[j];
+                    }
+                } else {
+                    for (size_t j = 0; j < cols; ++j) {
+                        dst_row[j] = x_row[j] - y_row[j];
+                    }
+                }
+            }
+        }
+
+        /**
+         * One level of the Winograd form. m, k and n are divisible by 2^level.
+         */
+        void recurse(View a, View b, Block c, size_t m, size_t k, size_t n, size_t level, unsigned max_threads) {
+            if (level == 0) {
+                gemm::multiply(gemm::Operand{a.data, a.ld, 1}, gemm::Operand{b.data, b.ld, 1}, c.data, c.ld,
+                               m, k, n, max_threads);
+                return;
+            }
+            const size_t hm = m / 2;
+            const size_t hk = k / 2;
+            const size_t hn = n / 2;
+            const View a11{a.data, a.ld}, a12{a.at(0, hk), a.ld}, a21{a.at(hm, 0), a.ld}, a22{a.at(hm, hk), a.ld};
+            const View b11{b.data, b.ld}, b12{b.at(0, hn), b.ld}, b21{b.at(hk, 0), b.ld}, b22{b.at(hk, hn), b.ld};
+            const Block c11{c.data, c.ld}, c12{c.at(0, hn), c.ld}, c21{c.at(hm, 0), c.ld}, c22{c.at(hm, hn), c.ld};
+
+            std::vector<double> s_buf(4 * hm * hk);
+            std::vector<double> t_buf(4 * hk * hn);
+            std::vector<double> p_buf(7 * hm * hn);
+            Block s[4];
+            Block t[4];
+            Block p[7];
+            for (size_t i = 0; i < 4; ++i) {
+                s[i] = Block{s_buf.data() + i * hm * hk, hk};
+                t[i] = Block{t_buf.data() + i * hk * hn, hn};
+            }
+            for (size_t i = 0; i < 7; ++i) {
+                p[i] = Block{p_buf.data() + i * hm * hn, hn};
+            }
+
+            combine(s[0], a21, a22, 1, hm, hk);    // S1 = A21 + A22
+            combine(s[1], s[0], a11, -1, hm, hk);  // S2 = S1 - A11
+            combine(s[2], a11, a21, -1, hm, hk);   // S3 = A11 - A21
+            combine(s[3], a12, s[1], -1, hm, hk);  // S4 = A12 - S2
+            combine(t[0], b12, b11, -1, hk, hn);   // T1 = B12 - B11
+            combine(t[1], b22, t[0], -1, hk, hn);  // T2 = B22 - T1
+            combine(t[2], b22, b12, -1, hk, hn);   // T3 = B22 - B12
+            combine(t[3], t[1], b21, -1, hk, hn);  // T4 = T2 - B21
+
+            recurse(a11, b11, p[0], hm, hk, hn, level - 1, max_threads);   // P1 = A11 B11
+            recurse(a12, b21, p[1], hm, hk, hn, level - 1, max_threads);   // P2 = A12 B21
+            recurse(s[3], b22, p[2], hm, hk, hn, level - 1, max_threads);  // P3 = S4 B22
+            recurse(a22, t[3], p[3], hm, hk, hn, level - 1, max_threads);  // P4 = A22 T4
+            recurse(s[0], t[0], p[4], hm, hk, hn, level - 1, max_threads); // P5 = S1 T1
+            recurse(s[1], t[1], p[5], hm, hk, hn, level - 1, max_threads); // P6 = S2 T2
+            recurse(s[2], t[2], p[6], hm, hk, hn, level - 1, max_threads); // P7 = S3 T3
+
+            combine(c11, p[0], p[1], 1, hm, hn);   // C11 = P1 + P2
+            combine(p[5], p[0], p[5], 1, hm, hn);  // U2 = P1 + P6
+            combine(p[6], p[5], p[6], 1, hm, hn);  // U3 = U2 + P7
+            combine(p[5], p[5], p[4], 1, hm, hn);  // U4 = U2 + P5
+            combine(c12, p[5], p[2], 1, hm, hn);   // C12 = U4 + P3
+            combine(c21, p[6], p[3], -1, hm, hn);  // C21 = U3 - P4
+            combine(c22, p[6], p[4], 1, hm, hn);   // C22 = U3 + P5
+        }
+
+        size_t roundUp(size_t value, size_t multiple) {
+            return (value + multiple - 1) / multiple * multiple;
+        }
+
+        /**
+         * Copies a (rows x cols) row-major matrix into the top-left corner of a zeroed (padded_rows x padded_cols) one.
+         */
+        std::vector<double> pad(const double *src, size_t rows, size_t cols, size_t padded_rows, size_t padded_cols) {
+            std::vector<double> padded(padded_rows * padded_cols, 0.0);
+            for (size_t i = 0; i < rows; ++i) {
+                std::copy(src + i * cols, src + (i + 1) * cols, padded.data() + i * padded_cols);
+            }
+            return padded;
+        }
+
+        double maxAbs(const double *data, size_t size) {
+            double max_abs = 0;
+            for (size_t i = 0; i < size; ++i) {
+                max_abs = std::max(max_abs, std::fabs(data[i]));
+            }
+            return max_abs;
+        }
+
+    }
+
+    void configure(bool enabled, size_t cutoff) {
+        cutoff_size.store(std::max<size_t>(cutoff, 1));
+        enabled_flag.store(enabled);
+    }
+
+    Config config() {
+        return Config{enabled_flag.load(), cutoff_size.load()};
+    }
+
+    size_t levels(size_t m, size_t k, size_t n, size_t cutoff) {
+        cutoff = std::max<size_t>(cutoff, 1);
+        size_t level = 0;
+        while (std::min({m, k, n}) > cutoff) {
+            m = (m + 1) / 2;
+            k = (k + 1) / 2;
+            n = (n + 1) / 2;
+            ++level;
+        }
+        return level;
+    }
+
+    void multiply(const double *a, const double *b, double *c, size_t m, size_t k, size_t n,
+                  size_t cutoff, unsigned max_threads) {
+        const size_t level = levels(m, k, n, cutoff);
+        const size_t multiple = size_t{1} << level;
+        const size_t pm = roundUp(m, multiple);
+        const size_t pk = roundUp(k, multiple);
+        const size_t pn = roundUp(n, multiple);
+        if (pm == m && pk == k && pn == n) {
+            recurse(View{a, k}, View{b, n}, Block{c, n}, m, k, n, level, max_threads);
+            return;
+        }
+        std::vector<double> padded_a{pad(a, m, k, pm, pk)};
+        std::vector<double> padded_b{pad(b, k, n, pk, pn)};
+        std::vector<double> padded_c(pm * pn);
+        recurse(View{padded_a.data(), pk}, View{padded_b.data(), pn}, Block{padded_c.data(), pn},
+                pm, pk, pn, level, max_threads);
+        for (size_t i = 0; i < m; ++i) {
+            std::copy(padded_c.data() + i * pn, padded_c.data() + i * pn + n, c + i * n);
+        }
+    }
+
+    ErrorBound errorBound(size_t m, size_t k, size_t n, size_t cutoff, double max_abs_a, double max_abs_b) {
+        const double unit_roundoff = DBL_EPSILON / 2;
+        const double scale = unit_roundoff * max_abs_a * max_abs_b;
+        const size_t level = levels(m, k, n, cutoff);
+        const auto inner = static_cast<double>(roundUp(k, size_t{1} << level));
+        const double leaf = inner / std::pow(2.0, static_cast<double>(level));
+        const double strassen_factor =
+                (leaf * leaf + 6 * leaf) * std::pow(18.0, static_cast<double>(level)) - 6 * inner;
+        const auto classic_k = static_cast<double>(k);
+        return ErrorBound{level, classic_k * classic_k * scale, strassen_factor * scale};
+    }
+
+    ErrorBound errorBound(const Matrix &left, const Matrix &right, size_t cutoff) {
+        const auto m = static_cast<size_t>(left.rows());
+        const auto k = static_cast<size_t>(left.cols());
+        const auto n = static_cast<size_t>(right.cols());
+        return errorBound(m, k, n, cutoff, maxAbs(left.data(), m * k), maxAbs(right.data(), k * n));
+    }
+
+}
@@ -0,0 +1,72 @@
+#ifndef CPP_EX3_STRASSEN_HPP
+#define CPP_EX3_STRASSEN_HPP
+
+#include <cstddef>
+
+/*
+ * Strassen-Winograd matrix multiplication (7 half-size products and 15 additions per level).
+ * The recursion stops at a tunable cutoff and hands the blocks to the classic kernel in Gemm.hpp.
+ * Odd sizes are handled by zero padding every dimension to a multiple of 2^levels once, at the top.
+ * https://en.wikipedia.org/wiki/Strassen_algorithm#Winograd_form
+ * Error analysis: N. J. Higham, Accuracy and Stability of Numerical Algorithms (2nd ed.), section 23.2.2.
+ */
+namespace zich {
+
+    template<class T>
+    class BasicMatrix;
+
+    template<>
+    class BasicMatrix<double>;
+
+    using Matrix = BasicMatrix<double>; // see Matrix.hpp
+
+    namespace strassen {
+
+        // recursion stops once a dimension is at or below this size
+        constexpr std::size_t DEFAULT_CUTOFF = 512;
+
+        struct Config {
+            bool enabled;
+            std::size_t cutoff;
+        };
+
+        /**
+         * Turns the Strassen-Winograd path of Matrix::operator* / operator*= on or off for the whole process.
+         * It is off by default. Products with a dimension at or below the cutoff always use the classic kernel.
+         */
+        void configure(bool enabled, std::size_t cutoff = DEFAULT_CUTOFF);
+
+        Config config();
+
+        /**
+         * @return number of recursion levels used for an (m x k) * (k x n) product
+         */
+        std::size_t levels(std::size_t m, std::size_t k, std::size_t n, std::size_t cutoff);
+
+        /**
+         * Computes C = A * B for contiguous row-major operands. C (m x n) is overwritten.
+         * @param max_threads per-call thread cap for the classic kernel at the leaves, 0 = global limit
+         */
+        void multiply(const double *a, const double *b, double *c, std::size_t m, std::size_t k, std::size_t n,
+                      std::size_t cutoff, unsigned max_threads = 0);
+
+        /**
+         * First-order bounds on max |C_computed - C| (u = unit roundoff, ||.|| = largest absolute entry):
+         *   classic:            k^2 u ||A|| ||B||
+         *   Strassen-Winograd:  ((k0^2 + 6 k0) 18^l - 6 k) u ||A|| ||B||   with k0 = k / 2^l
+         * where k is the (padded) inner dimension and l the number of recursion levels.
+         */
+        struct ErrorBound {
+            std::size_t levels;
+            double classic;
+            double strassen;
+        };
+
+        ErrorBound errorBound(std::size_t m, std::size_t k, std::size_t n, std::size_t cutoff,
+                              double max_abs_a, double max_abs_b);
+
+        ErrorBound errorBound(const Matrix &left, const Matrix &right, std::size_t cutoff);
+
+    }
+}
+#endif //CPP_EX3_STRASSEN_HPP
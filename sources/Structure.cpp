@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <cmath>
+#include "Structure.hpp"
+
+using std::size_t;
+
+namespace zich::structure {
+
+    namespace {
+
+        bool isSquare(const MatrixView &view) {
+            return view.rows() == view.cols();
+        }
+
+        bool isZero(const MatrixView &view) {
+            for (int i = 0; i < view.rows(); ++i) {
+                for (int j = 0; j < view.cols(); ++j) {
+                    if (view(i, j) != 0) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        /**
+         * Rows are scanned from the first entry right of the diagonal, so a dense matrix fails at (0, 1).
+         */
+        bool isUpperZero(const MatrixView &view) {
+            for (int i = 0; i < view.rows(); ++i) {
+                for (int j = i + 1; j < view.cols(); ++j) {
+                    if (view(i, j) != 0) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        bool isLowerZero(const MatrixView &view) {
+            for (int i = 1; i < view.rows(); ++i) {
+                for (int j = 0; j < i; ++j) {
+                    if (view(i, j) != 0) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        bool isDiagonal(const MatrixView &view) {
+            return isSquare(view) && isUpperZero(view) && isLowerZero(view);
+        }
+
+        bool hasUnitDiagonal(const MatrixView &view) {
+            for (int i = 0; i < view.rows(); ++i) {
+                if (view(i, i) != 1) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool isSymmetric(const MatrixView &view) {
+            if (!isSquare(view)) {
+                return false;
+            }
+            for (int i = 0; i < view.rows(); ++i) {
+                for (int j = i + 1; j < view.cols(); ++j) {
+                    if (view(i, j) != view(j, i)) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+    }
+
+    unsigned detect(const MatrixView &view) {
+        unsigned flags = isZero(view) ? static_cast<unsigned>(ZERO) : 0U;
+        if (!isSquare(view)) {
+            return flags;
+        }
+        flags |= isUpperZero(view) ? static_cast<unsigned>(LOWER) : 0U;
+        flags |= isLowerZero(view) ? static_cast<unsigned>(UPPER) : 0U;
+        if ((flags & (UPPER | LOWER)) == (UPPER | LOWER)) {
+            flags |= DIAGONAL | SYMMETRIC;
+            flags |= hasUnitDiagonal(view) ? static_cast<unsigned>(IDENTITY) : 0U;
+        } else if (isSymmetric(view)) {
+            flags |= SYMMETRIC;
+        }
+        return flags;
+    }
+
+    bool holds(const MatrixView &view, unsigned flags) {
+        if ((flags & (DIAGONAL | IDENTITY | UPPER | LOWER | SYMMETRIC)) && !isSquare(view)) {
+            return false;
+        }
+        return (!(flags & ZERO) || isZero(view)) &&
+               (!(flags & (UPPER | DIAGONAL | IDENTITY)) || isLowerZero(view)) &&
+               (!(flags & (LOWER | DIAGONAL | IDENTITY)) || isUpperZero(view)) &&
+               (!(flags & IDENTITY) || hasUnitDiagonal(view)) &&
+               (!(flags & SYMMETRIC) || isSymmetric(view));
+    }
+
+    bool allFinite(const MatrixView &view) {
+        for (int i = 0; i < view.rows(); ++i) {
+            for (int j = 0; j < view.cols(); ++j) {
+                if (!std::isfinite(view(i, j))) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /*
+     * The full product starts every entry at +0 and adds the terms in order of k. With finite entries on the other
+     * side, the terms skipped here are all +0 or -0, which leave a nonzero sum unchanged and turn -0 into +0.
+     * The cheap checks come first: isZero and isDiagonal stop at the first nonzero (off-diagonal) entry,
+     * and allFinite (a full pass) only runs once a fast path is possible.
+     */
+    bool multiply(const MatrixView &left, const MatrixView &right, double *product) {
+        const auto m = static_cast<size_t>(left.rows());
+        const auto n = static_cast<size_t>(right.cols());
+        if ((isZero(left) && allFinite(right)) || (isZero(right) && allFinite(left))) {
+            std::fill(product, product + m * n, 0.0);
+            return true;
+        }
+        if (isDiagonal(left) && allFinite(right)) { // row i of the product is left(i, i) * (row i of right)
+            for (int i = 0; i < left.rows(); ++i) {
+                const double scale = left(i, i);
+                double *row = product + static_cast<size_t>(i) * n;
+                for (int j = 0; j < right.cols(); ++j) {
+                    row[j] = scale * right(i, j) + 0.0;
+                }
+            }
+            return true;
+        }
+        if (isDiagonal(right) && allFinite(left)) { // column j of the product is (column j of left) * right(j, j)
+            for (int i = 0; i < left.rows(); ++i) {
+                double *row = product + static_cast<size_t>(i) * n;
+                for (int j = 0; j < right.cols(); ++j) {
+                    row[j] = left(i, j) * right(j, j) + 0.0;
+                }
+            }
+            return true;
+        }
+        return false;
+    }
+
+}
@@ -0,0 +1,50 @@
+#ifndef CPP_EX3_STRUCTURE_HPP
+#define CPP_EX3_STRUCTURE_HPP
+
+#include "MatrixView.hpp"
+
+/*
+ * Detection of special matrix structure (zero, diagonal, identity, triangular, symmetric).
+ * Every check stops at the first entry that rules the structure out, so a general dense matrix
+ * is rejected after a few comparisons, and a structured one costs one pass over its entries.
+ * Products with a zero or diagonal operand then take O(rows * cols) instead of O(n^3):
+ * https://en.wikipedia.org/wiki/Diagonal_matrix#Matrix_operations
+ */
+namespace zich::structure {
+
+    // flags combined in the mask returned by detect() (all but ZERO need a square matrix)
+    enum Flag : unsigned {
+        ZERO = 1U << 0,
+        DIAGONAL = 1U << 1,
+        IDENTITY = 1U << 2,
+        UPPER = 1U << 3, // upper triangular
+        LOWER = 1U << 4, // lower triangular
+        SYMMETRIC = 1U << 5
+    };
+
+    /**
+     * @return mask of every Flag that holds for the view
+     */
+    unsigned detect(const MatrixView &view);
+
+    /**
+     * Checks only the requested flags.
+     * @return true if every flag in the mask holds
+     */
+    bool holds(const MatrixView &view, unsigned flags);
+
+    /**
+     * @return true if no entry is infinite or NaN
+     */
+    bool allFinite(const MatrixView &view);
+
+    /**
+     * product = left * right when one side is zero or diagonal and the other has only finite entries
+     * (0 * inf would be NaN in the full product). The result has the same bits as the full product:
+     * skipped terms are exact zeros, and every entry is written as value + 0.0 so a zero comes out as +0.
+     * @return false (with product untouched) if no fast path applies
+     */
+    bool multiply(const MatrixView &left, const MatrixView &right, double *product);
+
+}
+#endif //CPP_EX3_STRUCTURE_HPP
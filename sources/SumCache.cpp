@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include "SumCache.hpp"
+#include "Reduce.hpp"
+
+using std::size_t;
+
+namespace zich {
+
+    namespace {
+
+        constexpr double UNIT_ROUNDOFF = DBL_EPSILON / 2;
+
+        // covers the rounding of the bound arithmetic itself
+        constexpr double SLACK = 1 + 0x1p-40;
+
+        /**
+         * Higham's gamma_n = n u / (1 - n u): the error of any summation order of n values is at most
+         * gamma_(n-1) times the sum of their absolute values. Compensated summation is far more accurate,
+         * its (2u + O(n u^2)) bound is covered by gamma_(n+4).
+         */
+        double gamma(size_t size) {
+            const double nu = static_cast<double>(size) * UNIT_ROUNDOFF;
+            return nu / (1 - nu);
+        }
+
+    }
+
+    SumCache::SumCache() : _sum{0}, _error{0}, _abs{0}, _state{UNKNOWN} {}
+
+    SumCache::SumCache(const SumCache &other) noexcept
+            : _sum{other._sum.load()}, _error{other._error.load()}, _abs{other._abs.load()},
+              _state{other._state.load()} {}
+
+    SumCache &SumCache::operator=(const SumCache &other) {
+        const unsigned char state = other._state.load();
+        _sum = other._sum.load();
+        _error = other._error.load();
+        _abs = other._abs.load();
+        _state = state;
+        return *this;
+    }
+
+    void SumCache::reset() {
+        _state = UNKNOWN;
+    }
+
+    /*
+     * Another thread may copy the cache while it is stored: the error is written first and never shrinks,
+     * so any mix of the old and new fields still bounds the real sum.
+     */
+    double SumCache::exact(const double *data, size_t size) const {
+        const unsigned char state = _state.load();
+        if (state == EXACT) {
+            return _sum.load();
+        }
+        double abs = 0;
+        const double sum = reduce::sumWithAbs(data, size, abs);
+        abs *= (1 + 2 * gamma(size + 4)) * SLACK; // the computed sum of absolute values may be slightly low
+        const double error = gamma(size + 4) * abs * SLACK;
+        _error = state == BOUNDED ? std::max(error, _error.load()) : error;
+        _abs = abs;
+        _sum = sum;
+        _state = EXACT;
+        return sum;
+    }
+
+    bool SumCache::bounds(size_t size, double &low, double &high) const {
+        const unsigned char state = _state.load();
+        const double sum = _sum.load();
+        if (state == EXACT) {
+            low = high = sum;
+            return true;
+        }
+        if (state == UNKNOWN) {
+            return false;
+        }
+        // the computed sum is within gamma_n * abs of the real sum, which is within _error of _sum
+        const double width = (_error.load() + gamma(size + 4) * _abs.load()) * SLACK;
+        if (!std::isfinite(sum) || !std::isfinite(width)) {
+            return false;
+        }
+        low = std::nextafter(sum - width, -INFINITY);
+        high = std::nextafter(sum + width, INFINITY);
+        return true;
+    }
+
+    void SumCache::setBounded(double sum, double error, double abs) {
+        if (!std::isfinite(sum) || !std::isfinite(error) || !std::isfinite(abs)) {
+            _state = UNKNOWN;
+            return;
+        }
+        _sum = sum;
+        _error = error * SLACK;
+        _abs = abs * SLACK;
+        _state = BOUNDED;
+    }
+
+    /*
+     * Each entry a + b is rounded by at most u |a + b|, so the real sum moves by at most u (abs + other abs),
+     * and adding the two cached sums rounds by at most u |new sum|.
+     */
+    void SumCache::add(const SumCache &other, bool subtract) {
+        const unsigned char state = _state.load();
+        const unsigned char other_state = other._state.load();
+        if (state == UNKNOWN || other_state == UNKNOWN) {
+            _state = UNKNOWN;
+            return;
+        }
+        const double other_sum = subtract ? -other._sum.load() : other._sum.load();
+        const double other_error = other._error.load();
+        const double other_abs = other._abs.load();
+        const double sum = _sum.load() + other_sum;
+        const double abs = _abs.load() + other_abs;
+        setBounded(sum, _error.load() + other_error + UNIT_ROUNDOFF * (abs + std::fabs(sum)),
+                   abs * (1 + UNIT_ROUNDOFF));
+    }
+
+    void SumCache::subtractFrom(const SumCache &left) {
+        add(left, true); // entries - left, then negated (which rounds the same way as left - entries)
+        scale(-1);
+    }
+
+    void SumCache::shift(double value, size_t size) {
+        if (_state.load() == UNKNOWN) {
+            return;
+        }
+        const double total = value * static_cast<double>(size);
+        const double sum = _sum.load() + total;
+        const double abs = _abs.load() + std::fabs(total);
+        setBounded(sum, _error.load() + UNIT_ROUNDOFF * (abs + std::fabs(total) + std::fabs(sum)),
+                   abs * (1 + UNIT_ROUNDOFF));
+    }
+
+    void SumCache::scale(double scalar) {
+        const unsigned char state = _state.load();
+        if (state == UNKNOWN || scalar == 1) {
+            return;
+        }
+        if (scalar == -1) { // rounding is symmetric, so the computed sum just flips its sign
+            _sum = -_sum.load();
+            return;
+        }
+        const double factor = std::fabs(scalar);
+        const double sum = _sum.load() * scalar;
+        const double abs = _abs.load() * factor;
+        setBounded(sum, _error.load() * factor + UNIT_ROUNDOFF * (abs + std::fabs(sum)), abs * (1 + UNIT_ROUNDOFF));
+    }
+
+    void SumCache::reorder() {
+        if (_state.load() == EXACT) {
+            _state = BOUNDED;
+        }
+    }
+
+}
@@ -0,0 +1,87 @@
+#ifndef CPP_EX3_SUMCACHE_HPP
+#define CPP_EX3_SUMCACHE_HPP
+
+#include <atomic>
+#include <cstddef>
+
+/*
+ * Cached sum of the entries of a matrix, used by the comparison operators.
+ * Once the sum has been computed, +=, -=, ++, -- and scalar *= update it in O(1). Such an update cannot reproduce
+ * the rounding of the summation, so the cache then holds an approximate sum with a rigorous error bound
+ * (the standard gamma_n bound for floating-point summation):
+ * https://en.wikipedia.org/wiki/Pairwise_summation#Accuracy
+ * A comparison is decided from the intervals when they do not overlap. Otherwise the exact sum is
+ * recomputed (and cached), so comparisons give exactly the same answers as summing every time.
+ * Only exact results are stored from const methods, and every thread stores the same bits, so concurrent
+ * comparisons of one matrix are safe (the fields are atomics).
+ */
+namespace zich {
+
+    class SumCache {
+
+    private:
+        enum State : unsigned char {
+            UNKNOWN,
+            BOUNDED, // _sum is within _error of the real sum of the entries
+            EXACT    // _sum is the computed sum, and within _error of the real sum
+        };
+
+        mutable std::atomic<double> _sum;
+        mutable std::atomic<double> _error;
+        mutable std::atomic<double> _abs; // upper bound on the sum of absolute values
+        mutable std::atomic<unsigned char> _state;
+
+        void setBounded(double sum, double error, double abs);
+
+    public:
+        SumCache();
+
+        SumCache(const SumCache &other) noexcept;
+
+        SumCache &operator=(const SumCache &other);
+
+        /**
+         * Forgets the sum (after a change that cannot be tracked).
+         */
+        void reset();
+
+        /**
+         * @return reduce::sum of the entries, from the cache if it is known exactly
+         */
+        double exact(const double *data, std::size_t size) const;
+
+        /**
+         * Interval that contains the exact computed sum.
+         * @return false if nothing useful is known
+         */
+        bool bounds(std::size_t size, double &low, double &high) const;
+
+        /**
+         * After entries[i] += other entries[i] (or -=). Other may be this cache.
+         */
+        void add(const SumCache &other, bool subtract);
+
+        /**
+         * After entries[i] = left entries[i] - entries[i].
+         */
+        void subtractFrom(const SumCache &left);
+
+        /**
+         * After entries[i] += value for all size entries.
+         */
+        void shift(double value, std::size_t size);
+
+        /**
+         * After entries[i] *= scalar (negation keeps an exact sum exact).
+         */
+        void scale(double scalar);
+
+        /**
+         * After the entries were rearranged (the real sum is unchanged, the computed sum may change).
+         */
+        void reorder();
+
+    };
+
+}
+#endif //CPP_EX3_SUMCACHE_HPP
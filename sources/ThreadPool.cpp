@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <chrono>
+#include "ThreadPool.hpp"
+#include "Trace.hpp"
+
+using std::size_t;
+
+namespace zich {
+
+    std::atomic<unsigned> ThreadPool::max_threads{0};
+
+    /**
+     * Shared state of one parallelFor call. Lives on the caller's stack until every task finished.
+     */
+    struct ThreadPool::Job {
+        const std::function<void(size_t)> *body;
+        unsigned limit; // max tasks of this job running at once
+        std::atomic<size_t> remaining;
+        std::atomic<unsigned> active{0};
+        std::mutex lock;
+        std::condition_variable done;
+        std::exception_ptr error;
+
+        Job(const std::function<void(size_t)> *body, unsigned limit, size_t count)
+                : body(body), limit(limit), remaining(count) {}
+
+        bool tryEnter() {
+            unsigned current = active.load();
+            while (current < limit) {
+                if (active.compare_exchange_weak(current, current + 1)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    ThreadPool::ThreadPool() {
+        unsigned hardware = std::max(1U, std::thread::hardware_concurrency());
+        for (unsigned i = 0; i + 1 < hardware; ++i) { // the calling thread is the last "worker"
+            _workers.push_back(std::make_unique<Worker>());
+        }
+        for (size_t i = 0; i < _workers.size(); ++i) {
+            _threads.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> guard{_sleep_lock};
+            _stop = true;
+        }
+        _wake_up.notify_all();
+        for (std::thread &thread: _threads) {
+            thread.join();
+        }
+    }
+
+    ThreadPool &ThreadPool::instance() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    void ThreadPool::setMaxThreads(unsigned threads) {
+        max_threads.store(threads);
+    }
+
+    unsigned ThreadPool::threadLimit(unsigned per_call) {
+        unsigned limit = static_cast<unsigned>(instance()._workers.size()) + 1;
+        unsigned global = max_threads.load();
+        if (global != 0) {
+            limit = std::min(limit, global);
+        }
+        if (per_call != 0) {
+            limit = std::min(limit, per_call);
+        }
+        return limit;
+    }
+
+    void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)> &body, unsigned max_threads) {
+        if (count == 0) {
+            return;
+        }
+        const unsigned limit = threadLimit(max_threads);
+        if (limit == 1 || count == 1) { // nothing to share, run inline
+            std::exception_ptr error;
+            for (size_t i = 0; i < count; ++i) {
+                try {
+                    body(i);
+                } catch (...) {
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+            }
+            if (error) {
+                std::rethrow_exception(error);
+            }
+            return;
+        }
+
+        Job job{&body, limit, count};
+        // contiguous chunks keep neighbouring tiles on the same worker until someone steals them
+        const size_t queues = std::min<size_t>(limit, _workers.size());
+        for (size_t q = 0; q < queues; ++q) {
+            std::lock_guard<std::mutex> guard{_workers[q]->lock};
+            for (size_t i = q * count / queues; i < (q + 1) * count / queues; ++i) {
+                _workers[q]->tasks.push_back(Task{&job, i});
+            }
+        }
+        _pending.fetch_add(count);
+        {
+            std::lock_guard<std::mutex> guard{_sleep_lock};
+        }
+        _wake_up.notify_all();
+
+        // help with our own job, then wait for the tasks other threads are still running
+        while (job.remaining.load() != 0) {
+            if (!runOne(_workers.size(), &job)) {
+                std::unique_lock<std::mutex> guard{job.lock};
+                job.done.wait_for(guard, std::chrono::milliseconds{1}, [&job] { return job.remaining.load() == 0; });
+            }
+        }
+        std::lock_guard<std::mutex> guard{job.lock}; // the last task may still be inside its critical section
+        if (job.error) {
+            std::rethrow_exception(job.error);
+        }
+    }
+
+    void ThreadPool::releaseWhenIdle(void (*release)()) {
+        std::lock_guard<std::mutex> guard{_sleep_lock};
+        if (std::find(_idle_releases.begin(), _idle_releases.end(), release) == _idle_releases.end()) {
+            _idle_releases.push_back(release);
+        }
+    }
+
+    /*
+     * A worker that found no task for IDLE_RELEASE frees its scratch memory once, then sleeps until woken.
+     */
+    void ThreadPool::workerLoop(size_t worker_id) {
+        bool released = true; // nothing to free before the first task
+        while (true) {
+            if (runOne(worker_id, nullptr)) {
+                released = false;
+                continue;
+            }
+            std::unique_lock<std::mutex> guard{_sleep_lock};
+            if (_stop) {
+                return;
+            }
+            const auto woken = [this] { return _stop || _pending.load() != 0; };
+            if (_pending.load() == 0 && !released) {
+                if (!_wake_up.wait_for(guard, IDLE_RELEASE, woken)) {
+                    const std::vector<void (*)()> releases = _idle_releases;
+                    guard.unlock();
+                    for (void (*release)() : releases) {
+                        release();
+                    }
+                    released = true;
+                }
+            } else if (_pending.load() == 0) {
+                _wake_up.wait(guard, woken);
+            } else { // tasks exist but their jobs are at their thread cap
+                _wake_up.wait_for(guard, std::chrono::milliseconds{1});
+            }
+        }
+    }
+
+    /**
+     * Takes one task (own deque from the back, other deques from the front) and runs it.
+     * @param own index of the calling worker, or _workers.size() for an external thread
+     * @param only_job if not null, only tasks of this job are taken
+     * @return false if no runnable task was found
+     */
+    bool ThreadPool::runOne(size_t own, const Job *only_job) {
+        const size_t queues = _workers.size();
+        const size_t start = own < queues ? own : 0;
+        for (size_t v = 0; v < queues; ++v) {
+            Worker &victim = *_workers[(start + v) % queues];
+            const bool is_own = (start + v) % queues == own;
+            Task task{};
+            {
+                std::lock_guard<std::mutex> guard{victim.lock};
+                if (victim.tasks.empty()) {
+                    continue;
+                }
+                Task candidate = is_own ? victim.tasks.back() : victim.tasks.front();
+                if ((only_job != nullptr && candidate.job != only_job) || !candidate.job->tryEnter()) {
+                    continue;
+                }
+                if (is_own) {
+                    victim.tasks.pop_back();
+                } else {
+                    victim.tasks.pop_front();
+                }
+                task = candidate;
+            }
+            _pending.fetch_sub(1);
+            runTask(task);
+            return true;
+        }
+        return false;
+    }
+
+    void ThreadPool::runTask(const Task &task) {
+        Job &job = *task.job;
+        try {
+            ZICH_TRACE("pool task");
+            (*job.body)(task.index);
+        } catch (...) {
+            std::lock_guard<std::mutex> guard{job.lock};
+            if (!job.error) {
+                job.error = std::current_exception();
+            }
+        }
+        job.active.fetch_sub(1);
+        // decrement under the lock: once the caller sees zero it may destroy the job
+        std::lock_guard<std::mutex> guard{job.lock};
+        if (job.remaining.fetch_sub(1) == 1) {
+            job.done.notify_all();
+        }
+    }
+
+}
@@ -0,0 +1,95 @@
+#ifndef CPP_EX3_THREADPOOL_HPP
+#define CPP_EX3_THREADPOOL_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Process-wide work-stealing thread pool.
+ * Every worker owns a deque: it pops its own tasks from the back and steals from the front of other deques.
+ * https://en.wikipedia.org/wiki/Work_stealing
+ */
+namespace zich {
+
+    class ThreadPool {
+    private:
+        struct Job;
+
+        struct Task {
+            Job *job;
+            std::size_t index;
+        };
+
+        struct Worker {
+            std::mutex lock;
+            std::deque<Task> tasks;
+        };
+
+        std::vector<std::unique_ptr<Worker>> _workers;
+        std::vector<std::thread> _threads;
+        std::mutex _sleep_lock;
+        std::condition_variable _wake_up;
+        std::atomic<std::size_t> _pending{0}; // queued tasks (not yet taken)
+        bool _stop{false};
+        std::vector<void (*)()> _idle_releases; // guarded by _sleep_lock
+
+        static std::atomic<unsigned> max_threads; // global cap, 0 means no cap
+
+        ThreadPool();
+
+        void workerLoop(std::size_t worker_id);
+
+        bool runOne(std::size_t first_victim, const Job *only_job);
+
+        static void runTask(const Task &task);
+
+    public:
+        ThreadPool(const ThreadPool &) = delete;
+
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        ~ThreadPool();
+
+        /**
+         * @return the process-wide pool (workers are started on first use)
+         */
+        static ThreadPool &instance();
+
+        /**
+         * Caps the number of threads used by every parallel call. 0 removes the cap.
+         */
+        static void setMaxThreads(unsigned threads);
+
+        /**
+         * @return number of threads a call with the given per-call cap (0 = none) may use, including the caller
+         */
+        static unsigned threadLimit(unsigned per_call = 0);
+
+        /**
+         * Runs body(i) for every i in [0, count) and blocks until all are done.
+         * The calling thread helps, and at most threadLimit(max_threads) threads run tasks of this call at once.
+         * The first exception thrown by a task is rethrown here after the remaining tasks finished.
+         */
+        void parallelFor(std::size_t count, const std::function<void(std::size_t)> &body, unsigned max_threads = 0);
+
+        /**
+         * Registers a function that frees the per-thread scratch memory of the calling thread.
+         * Every worker calls it on its own thread once it has had no task for IDLE_RELEASE,
+         * so scratch buffers are only kept by workers that are busy. Registering twice has no effect.
+         */
+        void releaseWhenIdle(void (*release)());
+
+        static constexpr std::chrono::milliseconds IDLE_RELEASE{100};
+    };
+
+}
+#endif //CPP_EX3_THREADPOOL_HPP
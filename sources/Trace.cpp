@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Trace.hpp"
+
+using std::size_t;
+using std::uint64_t;
+
+namespace zich::trace {
+
+    namespace {
+
+        const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+        /*
+         * Single-producer single-consumer ring: only the owning thread advances head, and only an exporter
+         * (holding registry_lock) advances tail. An event is written before head moves past it (release),
+         * and its slot is reused only after tail moved past it, so neither side ever waits for the other.
+         */
+        struct Ring {
+            std::atomic<size_t> head{0};
+            std::atomic<size_t> tail{0};
+            std::atomic<size_t> dropped{0};
+            unsigned thread;
+            std::vector<Event> events;
+
+            explicit Ring(unsigned thread_id) : thread(thread_id), events(RING_CAPACITY) {}
+
+            void push(const Event &event) {
+                const size_t position = head.load(std::memory_order_relaxed);
+                if (position - tail.load(std::memory_order_acquire) == RING_CAPACITY) {
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                events[position % RING_CAPACITY] = event;
+                head.store(position + 1, std::memory_order_release);
+            }
+        };
+
+        std::mutex registry_lock;
+
+        // every ring ever created, kept after its thread exits until its events are exported
+        std::vector<std::shared_ptr<Ring>> rings;
+
+        unsigned next_thread = 1;
+
+        Ring &threadRing() {
+            thread_local std::shared_ptr<Ring> ring;
+            if (!ring) {
+                std::lock_guard<std::mutex> guard{registry_lock};
+                ring = std::make_shared<Ring>(next_thread++);
+                rings.push_back(ring);
+            }
+            return *ring;
+        }
+
+        uint64_t nanoseconds(std::chrono::steady_clock::duration duration) {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+        }
+
+        void writeEvent(std::ostream &out, const Event &event, unsigned thread) {
+            out << "{\"name\":\"" << event.name << "\",\"cat\":\"matrix\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread
+                << ",\"ts\":" << static_cast<double>(event.start) / 1e3
+                << ",\"dur\":" << static_cast<double>(event.duration) / 1e3;
+            if (event.rows != 0 || event.flops != 0 || event.bytes != 0) {
+                out << ",\"args\":{\"rows\":" << event.rows << ",\"cols\":" << event.cols << ",\"flops\":"
+                    << std::llround(event.flops) << ",\"bytes\":" << std::llround(event.bytes) << '}';
+            }
+            out << '}';
+        }
+
+    }
+
+    void enable(bool on) {
+        recording = on;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> guard{registry_lock};
+        for (const std::shared_ptr<Ring> &ring : rings) {
+            ring->tail.store(ring->head.load(std::memory_order_acquire), std::memory_order_release);
+            ring->dropped = 0;
+        }
+    }
+
+    size_t dropped() {
+        std::lock_guard<std::mutex> guard{registry_lock};
+        size_t total = 0;
+        for (const std::shared_ptr<Ring> &ring : rings) {
+            total += ring->dropped.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    /*
+     * Timestamps are in microseconds with ns resolution (three decimals), as the format expects.
+     * Rings whose thread has exited are released once drained.
+     */
+    size_t writeChromeTrace(std::ostream &out) {
+        std::lock_guard<std::mutex> guard{registry_lock};
+        const auto old_flags = out.flags();
+        const auto old_precision = out.precision();
+        out << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        size_t written = 0;
+        bool first = true;
+        for (const std::shared_ptr<Ring> &ring : rings) {
+            out << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+                << ring->thread << ",\"args\":{\"name\":\"thread " << ring->thread << "\"}}";
+            first = false;
+            const size_t tail = ring->tail.load(std::memory_order_relaxed);
+            const size_t head = ring->head.load(std::memory_order_acquire);
+            for (size_t position = tail; position < head; ++position) {
+                out << ",\n";
+                writeEvent(out, ring->events[position % RING_CAPACITY], ring->thread);
+                ++written;
+            }
+            ring->tail.store(head, std::memory_order_release);
+        }
+        out << "\n]}\n";
+        out.flags(old_flags);
+        out.precision(old_precision);
+        rings.erase(std::remove_if(rings.begin(), rings.end(), [](const std::shared_ptr<Ring> &ring) {
+            return ring.use_count() == 1 && ring->head.load() == ring->tail.load();
+        }), rings.end());
+        return written;
+    }
+
+// ****************
+// Span
+// ****************
+
+    void Span::record() {
+        const auto end = std::chrono::steady_clock::now();
+        threadRing().push(Event{_name, nanoseconds(_start - epoch), nanoseconds(end - _start), _rows, _cols,
+                                _flops, _bytes});
+    }
+
+}
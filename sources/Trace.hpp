@@ -0,0 +1,126 @@
+#ifndef CPP_EX3_TRACE_HPP
+#define CPP_EX3_TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+/*
+ * Timeline tracing of Matrix operations, exported in the Chrome trace-event format
+ * (open the file in chrome://tracing or https://ui.perfetto.dev):
+ * https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+ * Every Matrix operator (but the comparisons, which are O(1) on cached sums), the stages of operator>>
+ * and every ThreadPool task open a span with ZICH_TRACE.
+ * A span records one complete event (name, start, duration, thread, and the shape, nominal bytes and FLOPs
+ * of the operation), so nested operators show up as nested bars on the thread's timeline.
+ * Each thread appends its events to its own ring buffer, without locks or allocation after its first event.
+ * When a ring is full, new events are dropped (and counted) until the next export drains it.
+ * Tracing is off until enable() is called: a span then costs one atomic load and a branch, inline.
+ * Enabled, it costs two clock reads and a store into the ring.
+ * Built with -DZICH_NO_TRACING, ZICH_TRACE expands to nothing, so the operators carry no tracing code at all
+ * (the functions below remain, and export an empty trace).
+ */
+namespace zich::trace {
+
+#if defined(ZICH_NO_TRACING)
+    constexpr bool COMPILED = false;
+#else
+    constexpr bool COMPILED = true;
+#endif
+
+    // events kept per thread between exports
+    constexpr std::size_t RING_CAPACITY = std::size_t{1} << 15;
+
+    struct Event {
+        const char *name; // string literal
+        std::uint64_t start; // ns since the trace epoch
+        std::uint64_t duration; // ns
+        int rows; // 0 if the span has no shape
+        int cols;
+        double flops;
+        double bytes;
+    };
+
+    // set by enable(), read inline by every Span
+    inline std::atomic<bool> recording{false};
+
+    /**
+     * Turns recording on or off for every thread (events already recorded are kept).
+     */
+    void enable(bool on = true);
+
+    inline bool enabled() {
+        return recording.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Drops every recorded event and the dropped-event count.
+     */
+    void clear();
+
+    /**
+     * @return events lost because a ring was full since the last clear
+     */
+    std::size_t dropped();
+
+    /**
+     * Drains every thread's ring and writes the events as a Chrome trace JSON object, one track per thread.
+     * Safe to call while other threads keep recording.
+     * @return number of events written
+     */
+    std::size_t writeChromeTrace(std::ostream &out);
+
+    /**
+     * Records the time from construction to destruction as one event (RAII).
+     * Use it through ZICH_TRACE, which compiles away with ZICH_NO_TRACING.
+     */
+    class Span {
+    private:
+        const char *_name; // nullptr if tracing was off at the start
+        std::chrono::steady_clock::time_point _start;
+        int _rows;
+        int _cols;
+        double _flops;
+        double _bytes;
+
+        void record();
+
+    public:
+        /**
+         * @param name string literal (only the pointer is stored)
+         */
+        explicit Span(const char *name, int rows = 0, int cols = 0, double flops = 0, double bytes = 0)
+                : _name(enabled() ? name : nullptr), _rows(rows), _cols(cols), _flops(flops), _bytes(bytes) {
+            if (_name != nullptr) {
+                _start = std::chrono::steady_clock::now();
+            }
+        }
+
+        Span(const Span &) = delete;
+
+        Span &operator=(const Span &) = delete;
+
+        ~Span() {
+            if (_name != nullptr) {
+                record();
+            }
+        }
+    };
+
+}
+
+#define ZICH_TRACE_JOIN(a, b) a##b
+#define ZICH_TRACE_NAME(line) ZICH_TRACE_JOIN(zich_trace_span_, line)
+
+#if defined(ZICH_NO_TRACING)
+#define ZICH_TRACE(...) static_cast<void>(0)
+#else
+/**
+ * Traces the rest of the enclosing scope: ZICH_TRACE("operator*=", rows, cols, flops, bytes);
+ */
+#define ZICH_TRACE(...) const zich::trace::Span ZICH_TRACE_NAME(__LINE__){__VA_ARGS__}
+#endif
+
+#endif //CPP_EX3_TRACE_HPP
@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "Transpose.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ZICH_TRANSPOSE_X86 1
+#include <immintrin.h>
+#endif
+
+using std::size_t;
+
+namespace zich::transpose {
+
+    namespace {
+
+        // leaf block edge (a 64x64 source and destination block together take 64 KiB, well inside L2)
+        constexpr size_t TILE = 64;
+
+        typedef void (*TileKernel)(const double *, size_t, double *, size_t, size_t, size_t);
+
+        void tileScalar(const double *src, size_t src_ld, double *dst, size_t dst_ld, size_t rows, size_t cols) {
+            for (size_t i = 0; i < rows; ++i) {
+                for (size_t j = 0; j < cols; ++j) {
+                    dst[j * dst_ld + i] = src[i * src_ld + j];
+                }
+            }
+        }
+
+#ifdef ZICH_TRANSPOSE_X86
+
+        __attribute__((target("sse2"))) void tileSse2(const double *src, size_t src_ld, double *dst, size_t dst_ld,
+                                                      size_t rows, size_t cols) {
+            size_t i = 0;
+            for (; i + 2 <= rows; i += 2) {
+                size_t j = 0;
+                for (; j + 2 <= cols; j += 2) {
+                    const __m128d row0 = _mm_loadu_pd(src + i * src_ld + j);
+                    const __m128d row1 = _mm_loadu_pd(src + (i + 1) * src_ld + j);
+                    _mm_storeu_pd(dst + j * dst_ld + i, _mm_unpacklo_pd(row0, row1));
+                    _mm_storeu_pd(dst + (j + 1) * dst_ld + i, _mm_unpackhi_pd(row0, row1));
+                }
+                tileScalar(src + i * src_ld + j, src_ld, dst + j * dst_ld + i, dst_ld, 2, cols - j);
+            }
+            tileScalar(src + i * src_ld, src_ld, dst + i, dst_ld, rows - i, cols);
+        }
+
+        __attribute__((target("avx"))) void tileAvx(const double *src, size_t src_ld, double *dst, size_t dst_ld,
+                                                    size_t rows, size_t cols) {
+            size_t j = 0;
+            for (; j + 4 <= cols; j += 4) { // walking down the source column writes each dst row sequentially
+                size_t i = 0;
+                for (; i + 4 <= rows; i += 4) {
+                    const double *block = src + i * src_ld + j;
+                    const __m256d row0 = _mm256_loadu_pd(block);
+                    const __m256d row1 = _mm256_loadu_pd(block + src_ld);
+                    const __m256d row2 = _mm256_loadu_pd(block + 2 * src_ld);
+                    const __m256d row3 = _mm256_loadu_pd(block + 3 * src_ld);
+                    const __m256d low01 = _mm256_unpacklo_pd(row0, row1);  // r0[0] r1[0] r0[2] r1[2]
+                    const __m256d high01 = _mm256_unpackhi_pd(row0, row1); // r0[1] r1[1] r0[3] r1[3]
+                    const __m256d low23 = _mm256_unpacklo_pd(row2, row3);
+                    const __m256d high23 = _mm256_unpackhi_pd(row2, row3);
+                    double *out = dst + j * dst_ld + i;
+                    _mm256_storeu_pd(out, _mm256_permute2f128_pd(low01, low23, 0x20));
+                    _mm256_storeu_pd(out + dst_ld, _mm256_permute2f128_pd(high01, high23, 0x20));
+                    _mm256_storeu_pd(out + 2 * dst_ld, _mm256_permute2f128_pd(low01, low23, 0x31));
+                    _mm256_storeu_pd(out + 3 * dst_ld, _mm256_permute2f128_pd(high01, high23, 0x31));
+                }
+                tileSse2(src + i * src_ld + j, src_ld, dst + j * dst_ld + i, dst_ld, rows - i, 4);
+            }
+            tileSse2(src + j, src_ld, dst + j * dst_ld, dst_ld, rows, cols - j);
+        }
+
+#endif
+
+        struct Variant {
+            const char *name;
+            TileKernel kernel;
+        };
+
+        const Variant &selectVariant() {
+            static const Variant scalar{"scalar", tileScalar};
+#ifdef ZICH_TRANSPOSE_X86
+            static const Variant sse2{"sse2", tileSse2};
+            static const Variant avx{"avx", tileAvx};
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx")) {
+                return avx;
+            }
+            if (__builtin_cpu_supports("sse2")) {
+                return sse2;
+            }
+#endif
+            return scalar;
+        }
+
+        const Variant &activeVariant() {
+            static const Variant &selected = selectVariant(); // CPUID is queried only once
+            return selected;
+        }
+
+        void recurse(const double *src, size_t src_ld, double *dst, size_t dst_ld, size_t rows, size_t cols,
+                     TileKernel kernel) {
+            if (rows <= TILE && cols <= TILE) {
+                kernel(src, src_ld, dst, dst_ld, rows, cols);
+                return;
+            }
+            if (rows >= cols) { // split rows, keeping the halves multiples of the register tile
+                const size_t half = (rows / 2 + 3) / 4 * 4;
+                recurse(src, src_ld, dst, dst_ld, half, cols, kernel);
+                recurse(src + half * src_ld, src_ld, dst + half, dst_ld, rows - half, cols, kernel);
+            } else {
+                const size_t half = (cols / 2 + 3) / 4 * 4;
+                recurse(src, src_ld, dst, dst_ld, rows, half, kernel);
+                recurse(src + half, src_ld, dst + half * dst_ld, dst_ld, rows, cols - half, kernel);
+            }
+        }
+
+        /**
+         * Square case: diagonal tiles are transposed through a scratch tile, mirrored off-diagonal tiles are swapped.
+         */
+        void inPlaceSquare(double *data, size_t size, TileKernel kernel) {
+            double scratch[TILE * TILE];
+            for (size_t bi = 0; bi < size; bi += TILE) {
+                const size_t rows = std::min(TILE, size - bi);
+                double *diagonal = data + bi * size + bi;
+                kernel(diagonal, size, scratch, TILE, rows, rows);
+                for (size_t i = 0; i < rows; ++i) {
+                    std::copy(scratch + i * TILE, scratch + i * TILE + rows, diagonal + i * size);
+                }
+                for (size_t bj = bi + TILE; bj < size; bj += TILE) {
+                    const size_t cols = std::min(TILE, size - bj);
+                    double *upper = data + bi * size + bj; // (rows x cols)
+                    double *lower = data + bj * size + bi; // (cols x rows)
+                    kernel(upper, size, scratch, TILE, rows, cols); // scratch is (cols x rows)
+                    kernel(lower, size, upper, size, cols, rows);
+                    for (size_t i = 0; i < cols; ++i) {
+                        std::copy(scratch + i * TILE, scratch + i * TILE + rows, lower + i * size);
+                    }
+                }
+            }
+        }
+
+        /**
+         * Rectangular case: entry k = i * cols + j moves to j * rows + i = k * rows mod (size - 1).
+         * The first and last entries stay where they are.
+         */
+        void inPlaceCycles(double *data, size_t rows, size_t cols) {
+            const size_t size = rows * cols;
+            const size_t modulus = size - 1;
+            std::vector<std::uint64_t> visited((size + 63) / 64, 0);
+            for (size_t start = 1; start < modulus; ++start) {
+                if ((visited[start / 64] >> (start % 64)) & 1) {
+                    continue;
+                }
+                double carried = data[start];
+                size_t pos = start;
+                do {
+                    pos = pos * rows % modulus;
+                    std::swap(carried, data[pos]);
+                    visited[pos / 64] |= std::uint64_t{1} << (pos % 64);
+                } while (pos != start);
+            }
+        }
+
+    }
+
+    void copy(const double *src, size_t src_ld, double *dst, size_t dst_ld, size_t rows, size_t cols) {
+        recurse(src, src_ld, dst, dst_ld, rows, cols, activeVariant().kernel);
+    }
+
+    void inPlace(double *data, size_t rows, size_t cols) {
+        if (rows == cols) {
+            inPlaceSquare(data, rows, activeVariant().kernel);
+        } else if (rows > 1 && cols > 1) { // a single row or column is already laid out as its transpose
+            inPlaceCycles(data, rows, cols);
+        }
+    }
+
+    const char *variant() {
+        return activeVariant().name;
+    }
+
+}
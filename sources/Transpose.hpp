@@ -0,0 +1,38 @@
+#ifndef CPP_EX3_TRANSPOSE_HPP
+#define CPP_EX3_TRANSPOSE_HPP
+
+#include <cstddef>
+
+/*
+ * Matrix transposition kernels.
+ * Out of place: the larger dimension is halved recursively until a block is at most 64x64, so the algorithm is
+ * cache-oblivious (no tuning for a particular cache or TLB size). Leaf blocks are transposed in 4x4 register tiles
+ * (AVX) or 2x2 tiles (SSE2), picked once at runtime like Simd.hpp:
+ * https://en.wikipedia.org/wiki/Cache-oblivious_algorithm
+ * In place: square matrices swap mirrored tile pairs. Rectangular ones follow the cycles of the permutation
+ * index -> index * rows mod (size - 1), with one bit per entry to mark visited positions:
+ * https://en.wikipedia.org/wiki/In-place_matrix_transposition
+ */
+namespace zich::transpose {
+
+    /**
+     * dst = transpose of the (rows x cols) row-major block src. dst is (cols x rows).
+     * @param src_ld distance between rows of src
+     * @param dst_ld distance between rows of dst
+     */
+    void copy(const double *src, std::size_t src_ld, double *dst, std::size_t dst_ld, std::size_t rows,
+              std::size_t cols);
+
+    /**
+     * Transposes a contiguous (rows x cols) matrix in its own buffer. Afterwards it is (cols x rows).
+     * Square matrices need no extra memory beyond a tile; rectangular ones need rows * cols bits.
+     */
+    void inPlace(double *data, std::size_t rows, std::size_t cols);
+
+    /**
+     * @return name of the tile kernel in use ("avx", "sse2" or "scalar")
+     */
+    const char *variant();
+
+}
+#endif //CPP_EX3_TRANSPOSE_HPP